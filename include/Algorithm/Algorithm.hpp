@@ -14,6 +14,7 @@
 #include "Sinks/DataSink.hpp"
 #include "Timer/Timer.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <filesystem>
 #include <memory>
@@ -26,6 +27,17 @@ namespace SESAME {
 class Algorithm;
 typedef std::shared_ptr<Algorithm> AlgorithmPtr;
 
+/**
+ * View of the clusters of an algorithm, one pseudo point per cluster, as they
+ * were after num_points ingested points. A published view is never modified
+ * again, so readers must not modify it either.
+ */
+struct ClusterSnapshot {
+  size_t num_points = 0;
+  std::vector<PointPtr> centers;
+};
+typedef std::shared_ptr<const ClusterSnapshot> ClusterSnapshotPtr;
+
 class Algorithm {
 public:
   Algorithm() = default;
@@ -33,9 +45,22 @@ public:
   virtual void Init() = 0;
   virtual void RunOnline(SESAME::PointPtr input) = 0;
   virtual void RunOffline(SESAME::DataSinkPtr ptr) = 0;
-  void Insert(SESAME::PointPtr input) {};
+  virtual void Insert(SESAME::PointPtr input) {};
   virtual void OutputOnline(std::vector<PointPtr> &centers) {};
   void Store(std::string output_file, int dim, std::vector<PointPtr> results);
+  /**
+   * Publish a view of the current clusters for Query(). Called on the ingest
+   * thread every param.snapshot_interval points by the algorithms that
+   * support it; by default nothing is published
+   */
+  virtual void Snapshot() {}
+  /**
+   * @return the latest view published by Snapshot(), or nullptr before the
+   * first one. Safe to call from any thread while points are ingested: a view
+   * is published by swapping one pointer, so readers never wait for the
+   * ingest thread and keep their view alive for as long as they hold it
+   */
+  ClusterSnapshotPtr Query() const { return snapshot.load(); }
   Timer win_timer, ds_timer, out_timer, ref_timer, sum_timer, lat_timer,
       on_timer;
   param_t param;
@@ -70,6 +95,28 @@ public:
       cnt = 1;
     }
   }
+
+protected:
+  /**
+   * Count an ingested point, calling Snapshot() once every
+   * param.snapshot_interval points
+   */
+  void SnapshotTick() {
+    ingested++;
+    if (param.snapshot_interval > 0 &&
+        ingested % param.snapshot_interval == 0)
+      Snapshot();
+  }
+  void Publish(std::vector<PointPtr> centers) {
+    auto view = std::make_shared<ClusterSnapshot>();
+    view->num_points = ingested;
+    view->centers = std::move(centers);
+    snapshot.store(ClusterSnapshotPtr(std::move(view)));
+  }
+
+private:
+  std::atomic<ClusterSnapshotPtr> snapshot;
+  size_t ingested = 0;
 };
 
 } // namespace SESAME
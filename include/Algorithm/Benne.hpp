@@ -8,10 +8,12 @@
 #include "Algorithm/Algorithm.hpp"
 #include "Algorithm/DesignAspect/Generic.hpp"
 #include "Algorithm/OfflineRefinement/KMeans.hpp"
+#include "Algorithm/OfflineRefinement/MiniBatchKMeans.hpp"
 #include "Algorithm/WindowModel/LandmarkWindow.hpp"
 #include "Sinks/DataSink.hpp"
 #include "Utils/BenchmarkUtils.hpp"
 
+#include <future>
 #include <utility>
 
 namespace SESAME {
@@ -40,6 +42,7 @@ public:
   outlierSelection outlierSel;
   refineSelection refineSel;
   KMeans kmeans;
+  MiniBatchKMeans miniBatchKMeans;
   int first_algo;
   size_t change_count = 0;
   std::vector<std::pair<int, int>> change_log;
@@ -57,8 +60,19 @@ public:
   void RunOnline(PointPtr input) override;
 
   void RunOffline(DataSinkPtr sinkPtr) override;
+  /**
+   * Publish the materialized centres and the current centres of the running
+   * algorithm. The running algorithm does not snapshot on its own, its view
+   * is taken here
+   */
+  void Snapshot() override;
 
 private:
+  // Refined centres of the incremental refinement running in the background
+  std::future<std::vector<PointPtr>> refinement;
+
+  std::vector<PointPtr> Refine(std::vector<PointPtr> &centers);
+  void InstallRefinement(bool wait);
   void Train(const PointPtr &point);
   int Infer(const SESAME::PointPtr &input);
   void UpdateAlgo(int, int);
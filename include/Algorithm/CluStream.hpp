@@ -61,13 +61,24 @@ public:
 private:
   void initOffline(vector<PointPtr> &initData, vector<PointPtr> &initialData);
   void incrementalCluster(PointPtr data);
-  double calRadius(MicroClusterPtr closestCluster);
+  double calRadius(int closestIndex);
   void insertIntoCluster(PointPtr data, MicroClusterPtr closestCluster);
   bool deleteCreateCluster(PointPtr data);
   void MergeCreateCluster(PointPtr data);
   void microClusterToPoint(MicroClusters &microClusters,
                            vector<PointPtr> &points) const;
-  static double distance(dataPoint a, dataPoint b, int dim);
+  double squaredDistance(int indexA, int indexB) const;
+  void markChanged(int index);
+  void repairNearest();
+
+  // Nearest other micro cluster of each micro cluster and the squared
+  // distance between their centroids. Entries of micro clusters whose centroid
+  // changed since the last repair are stale until repairNearest runs, which
+  // happens only when a merge or a radius estimate needs them.
+  std::vector<int> nearestCluster;
+  std::vector<double> nearestDistance;
+  std::vector<bool> changed;
+  std::vector<int> changedClusters;
 
   bool initilized = false;
   vector<PointPtr> initialInputs;
@@ -10,27 +10,55 @@
 #include "Algorithm/OfflineRefinement/ConnectedRegions.hpp"
 #include "Utils/BenchmarkUtils.hpp"
 
+#include <queue>
+#include <unordered_map>
+
 namespace SESAME {
 
 typedef std::vector<std::vector<MicroClusterPtr>> Clusters;
+/**
+ * Projected time at which a micro cluster (edge == false, key is its id) or a
+ * shared density edge (edge == true, key is its packed id pair) becomes weak.
+ * Weights only grow on updates, so the projection never comes too late; each
+ * micro cluster and edge has exactly one pending event.
+ */
+struct ExpiryEvent {
+  int dueTime;
+  bool edge;
+  WeightedAdjacencyList::Key key;
+};
+struct LaterExpiryEvent {
+  bool operator()(const ExpiryEvent &event1, const ExpiryEvent &event2) const {
+    return event1.dueTime > event2.dueTime;
+  }
+};
+typedef std::priority_queue<ExpiryEvent, std::vector<ExpiryEvent>,
+                            LaterExpiryEvent>
+    ExpiryQueue;
 class DBStreamParams : public SesameParam {
 public:
   double radius;
   double lambda;
-  int clean_interval; // Time gap
+  int clean_interval; // decay steps to the weak threshold
   double min_weight;  // minimum weight
   double alpha;       // α, intersection factor
   double base;        // base of decay function
+  int rebuild_interval; // points between rebuilds of the online regions
 };
 
 class DBStream : public Algorithm {
 public:
+  // Maximum number of expiry events handled per point, which bounds the
+  // latency cleanup adds to a single insertion
+  constexpr static const int CLEAN_SLICE = 16;
   DBStreamParams dbStreamParams;
   DampedWindowPtr dampedWindow;
   std::vector<MicroClusterPtr> microClusters;
+  std::unordered_map<int, size_t> slotOfId; // micro cluster id -> index
   SESAME::WeightedAdjacencyList weightedAdjacencyList;
   std::vector<MicroClusterPtr>
       microClusterNN; // micro clusters found in function findFixedRadiusNN
+  ExpiryQueue expiryQueue; // Pending weak entry checks, earliest first
   double weakEntry;   // W_weak, weak entries
   double aWeakEntry;
   timespec startTime;
@@ -42,6 +70,7 @@ public:
   int pointArrivingTime;
   int lastCleanTime;
   int microClusterIndex;
+  int pointsSinceRebuild;
   // Final output of clusters
   Clusters finalClusters;
   ConnectedRegions connectedRegions;
@@ -53,15 +82,21 @@ public:
   void Init() override;
   void RunOnline(PointPtr input) override;
   void RunOffline(DataSinkPtr sinkPtr) override;
+  void Snapshot() override;
 
 private:
   bool isInitial = false;
+  // Whether the connected regions are kept up to date while points arrive
+  bool onlineRegions() const { return dbStreamParams.rebuild_interval > 0; }
 
   void update(PointPtr dataPoint);
   bool checkMove(std::vector<MicroClusterPtr> microClusters) const;
   std::vector<MicroClusterPtr> findFixedRadiusNN(PointPtr dataPoint,
                                                  double decayFactor);
+  int expiryTime(int nowTime, double weight, double threshold) const;
   void cleanUp(int nowTime);
+  void removeMicroCluster(size_t slot);
+  std::vector<PointPtr> macroClusters();
 };
 
 } // namespace SESAME
@@ -8,6 +8,7 @@
 #include "Utils/BenchmarkUtils.hpp"
 
 #include <omp.h>
+#include <queue>
 
 /* Used Parameter in DStream:
 double lambda: user defined parameter lambda in damped window
@@ -25,9 +26,22 @@ timestamp.
 
 namespace SESAME {
 class DStream;
-typedef std::unordered_map<DensityGrid, CharacteristicVector, GridKeyHash,
-                           EqualGrid>
-    HashMap;
+/**
+ * A pending evaluation of a grid, due at dueTime. Entries are not removed when
+ * a grid is rescheduled; an entry is stale once its dueTime no longer matches
+ * the one recorded in the grid's characteristic vector.
+ */
+struct GridEvent {
+  int dueTime;
+  DensityGrid grid;
+};
+struct LaterGridEvent {
+  bool operator()(const GridEvent &event1, const GridEvent &event2) const {
+    return event1.dueTime > event2.dueTime;
+  }
+};
+typedef std::priority_queue<GridEvent, std::vector<GridEvent>, LaterGridEvent>
+    GridEventQueue;
 class DStream : public Algorithm {
 public:
   DampedWindowPtr dampedWindow;
@@ -48,23 +62,31 @@ public:
   std::vector<double> maxVals; // The maximum value seen for a numerical dim;
                                // used to calculate N
   bool init = false;
+  GridEventQueue densityQueue;  // Grids due for an attribute refresh
+  GridEventQueue sporadicQueue; // Grids due for a sporadic check
+  std::vector<DensityGrid> changedGrids; // Grids whose attribute changed in
+                                         // the latest density update
 
   DStream(param_t &cmd_params);
   ~DStream();
   void Init() override;
   void RunOnline(PointPtr input) override;
   void RunOffline(DataSinkPtr sinkPtr) override;
+  void Snapshot() override;
 
 private:
   bool recalculateN = false; // flag indicating whether N needs to be
                              // recalculated after this instance
+  bool densityRescan = true;  // dl/dm changed, all grids must be refreshed
+  bool sporadicRescan = true; // N/gap changed, all grids must be re-checked
   std::vector<int> Coord;
+  std::vector<DensityGrid> neighbours; // Scratch space for neighbour grids
   void ifReCalculate(PointPtr point);
+  std::vector<PointPtr> gridClusterCenters();
   void reCalculateParameter();
   void GridListUpdate(std::vector<int> coordinate);
   void initialClustering();
   void adjustClustering();
-  bool adjustLabels();
   bool inspectChangedGrids();
   HashMap adjustForSparseGrid(DensityGrid grid,
                               CharacteristicVector characteristicVec,
@@ -87,6 +109,14 @@ private:
                                            double decayFactor, int NGrids);
   bool checkIfSporadic(CharacteristicVector characteristicVec);
   void updateGridListDensity();
+  void refreshGridDensity(const DensityGrid &grid,
+                          CharacteristicVector &characteristicVec);
+  int nextSporadicCheck(const CharacteristicVector &characteristicVec);
+  void scheduleGrid(GridEventQueue &queue, int CharacteristicVector::*dueTime,
+                    const DensityGrid &grid,
+                    CharacteristicVector &characteristicVec, int time);
+  std::vector<DensityGrid> popDueGrids(GridEventQueue &queue,
+                                       int CharacteristicVector::*dueTime);
   static void mergeGridList(HashMap &gridList, const HashMap &otherList);
   // HashMap putHashMap(HashMap gList, const DensityGrid& g,
   // CharacteristicVector cv);
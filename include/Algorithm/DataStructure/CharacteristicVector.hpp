@@ -5,6 +5,7 @@
 #ifndef SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_CHARACTERISTICVECTOR_HPP_
 #define SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_CHARACTERISTICVECTOR_HPP_
 #include <Algorithm/WindowModel/DampedWindow.hpp>
+#include <climits>
 #include <cmath>
 #include <ctime>
 namespace SESAME {
@@ -55,6 +56,19 @@ public:
   bool attChange;
   bool isVisited = false;
 
+  /**
+   * Time stamps at which the grid is next due for an attribute refresh and a
+   * sporadic check respectively; used by DStream to evaluate grids lazily.
+   */
+  int densityDueTime = -1;
+  int sporadicDueTime = -1;
+
+  /**
+   * Number of points of the current sliding window that fall into the grid;
+   * used by V16 to drop the grid as soon as its last point expires.
+   */
+  int windowCount = 0;
+
   CharacteristicVector();
   CharacteristicVector(int updateTime, int removeTime, double Density,
                        int label, bool isSporadic, double dl, double dm);
@@ -84,6 +98,15 @@ public:
   void UpdateAllDensity(int NowTime, double decayFactor, double dl, double dm);
   void UpdateAllDensity(int NowTime, double dl, double dm);
   void ChangeAttribute(double dl, double dm);
+  /**
+   * Predicts the earliest time stamp at which decay alone moves the grid to a
+   * lower attribute (DENSE -> TRANSITIONAL or TRANSITIONAL -> SPARSE). The
+   * estimate errs on the early side, so callers must re-check when it is due.
+   *
+   * @return the predicted time stamp, or INT_MAX if the attribute never
+   * changes without new data
+   */
+  int nextAttributeChange(double decayFactor, double dl, double dm) const;
 };
 } // namespace SESAME
 #endif // SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_CHARACTERISTICVECTOR_HPP_
@@ -35,6 +35,9 @@ public:
   static void clearMicroCluster(MicroClusterPtr microCluster);
   static SnapshotPtr createSnapshot(MicroClusters &otherMicroClusters,
                                     int elapsedTime);
+  static SnapshotPtr createSnapshot(MicroClusters &otherMicroClusters,
+                                    int elapsedTime,
+                                    const SnapshotPtr &previous);
   static void clearSnapshot(SnapshotPtr snapshot);
   static CFTreePtr createCFTree();
   static NodePtr createNode();
@@ -46,14 +49,6 @@ public:
   static CachePtr creatCache(int num, double a, double lamd, double r);
   static OutPtr createOutlierReservoir();
   static OutPtr createOutlierReservoir(double r, double a, double lamd);
-
-  static MicroClusterPairPtr
-  createMicroClusterPair(MicroClusterPtr microCluster1,
-                         MicroClusterPtr microCluster2);
-  static void clearMicroClusterPair(MicroClusterPairPtr microClusterPair);
-  static AdjustedWeightPtr createAdjustedWeight(double weight, int pointTime,
-                                                timespec pointTime0);
-  static void clearAdjustedWeight(AdjustedWeightPtr adjustedWeight);
 };
 } // namespace SESAME
 #endif // SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_DATASTRUCTUREFACTORY_HPP_
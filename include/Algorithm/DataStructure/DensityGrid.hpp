@@ -58,6 +58,41 @@ public:
    */
   std::vector<DensityGrid> getNeighbours() const;
 
+  /**
+   * Same as getNeighbours, but fills neighbours in place. Reusing the vector
+   * across calls keeps neighbour generation allocation-free.
+   *
+   * @param neighbours filled with the neighbours of this density grid
+   */
+  void getNeighbours(std::vector<DensityGrid> &neighbours) const;
+
+  /**
+   * Visits the same neighbours as getNeighbours without allocating them: probe
+   * is overwritten with each neighbour in turn, so reusing one probe across
+   * calls keeps neighbour generation allocation-free.
+   *
+   * @param probe scratch density grid holding the current neighbour
+   * @param visit called with each neighbour, returning true stops the visit
+   * @return TRUE if the visit was stopped by visit, FALSE otherwise
+   */
+  template <typename Visitor>
+  bool forEachNeighbour(DensityGrid &probe, Visitor &&visit) const {
+    probe.dims = this->dims;
+    probe.coordinates.assign(this->coordinates.begin(),
+                             this->coordinates.end());
+    const DensityGrid &neighbour = probe;
+    for (int i = 0; i < this->dims; i++) {
+      probe.coordinates[i] -= 1;
+      if (visit(neighbour))
+        return true;
+      probe.coordinates[i] += 2;
+      if (visit(neighbour))
+        return true;
+      probe.coordinates[i] -= 1;
+    }
+    return false;
+  }
+
   /**
    * Provides the probability of the argument instance belonging to the density
    * grid in question.
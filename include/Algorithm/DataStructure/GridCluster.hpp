@@ -4,6 +4,7 @@
 
 #ifndef SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_GRIDCLUSTER_HPP_
 #define SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_GRIDCLUSTER_HPP_
+#include <Algorithm/DataStructure/CharacteristicVector.hpp>
 #include <Algorithm/DataStructure/DensityGrid.hpp>
 #include <algorithm>
 #include <functional>
@@ -11,8 +12,16 @@
 namespace SESAME {
 class GridCluster;
 typedef std::unordered_map<DensityGrid, bool, GridKeyHash, EqualGrid> HashGrids;
+// Grid list of D-Stream and its variants: the characteristic vector of every
+// grid
+typedef std::unordered_map<DensityGrid, CharacteristicVector, GridKeyHash,
+                           EqualGrid>
+    HashMap;
 class GridCluster {
 public:
+  // Share of changed grids above which relabelling the whole grid list by
+  // connectedClusters is cheaper than adjusting the changed grids one by one
+  constexpr static const double RELABEL_RATIO = 0.125;
   HashGrids grids;
   HashGrids visited;
   int clusterLabel;
@@ -60,7 +69,7 @@ public:
   /**
    * add a grid into grids, if exists, update value, if not, insert
    */
-  void putHashGrid(HashGrids grids1, const DensityGrid &g, bool inside);
+  void putHashGrid(HashGrids &grids1, const DensityGrid &g, bool inside);
 
   /**
    * Tests a grid cluster for connectedness according to Definition 3.4, Grid
@@ -84,6 +93,19 @@ public:
    */
   double getInclusionProb(Point point);
   bool operator==(GridCluster &Other) const;
+
+  /**
+   * Clusters a grid list from scratch as the initial clustering of Chen and Tu
+   * 2007 (Figure 3) converges to: dense and transitional grids which are
+   * neighbours end up in the same cluster, and every cluster holds at least one
+   * dense grid. Runs one parallel pass over the grids with a concurrent
+   * union-find, so the result does not depend on the thread schedule.
+   *
+   * @param gridList the grid list whose labels are overwritten with the index
+   * of their cluster, or NO_CLASS
+   * @return the clusters, where the cluster label equals the index
+   */
+  static std::vector<GridCluster> connectedClusters(HashMap &gridList);
 };
 
 } // namespace SESAME
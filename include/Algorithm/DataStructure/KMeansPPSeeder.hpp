@@ -0,0 +1,53 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#ifndef SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_KMEANSPPSEEDER_HPP_
+#define SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_KMEANSPPSEEDER_HPP_
+#include <Algorithm/DataStructure/Point.hpp>
+#include <vector>
+namespace SESAME {
+
+/**
+ * D^2 sampling state of k-means++ seeding over a static set of weighted
+ * points. The squared distance of every point to its nearest centre is kept
+ * and only compared against the newest centre when one is added, together with
+ * the prefix sums of the weighted squared distances, so each round costs one
+ * pass over the points and a sample is drawn by binary search.
+ */
+class KMeansPPSeeder {
+public:
+  /**
+   * @param weights the weight of each point, all points weigh 1 if empty
+   */
+  explicit KMeansPPSeeder(const std::vector<PointPtr> &points,
+                          const std::vector<double> &weights = {});
+  /**
+   * Fold a new centre into the distances of the points to their nearest centre
+   */
+  void addCentre(const PointPtr &centre);
+  /**
+   * @return the index of the first point whose prefix sum of weighted squared
+   * distances reaches u, or -1 if u exceeds total(). A point whose weighted
+   * squared distance is 0 is never returned
+   */
+  int sample(double u) const;
+  /**
+   * @return the sum of the weighted squared distances of the points to their
+   * nearest centre, i.e. the cost of the centres added so far
+   */
+  double total() const { return prefix.empty() ? 0 : prefix.back(); }
+  /**
+   * @return whether every point lies on a centre, e.g. when there are fewer
+   * distinct points than centres, so no further centre can be drawn
+   */
+  bool exhausted() const { return !(total() > 0); }
+
+private:
+  int dim;
+  std::vector<double> coordinates; // one row of dim values per point
+  std::vector<double> weights;
+  std::vector<double> minDistances; // squared, to the nearest centre
+  std::vector<double> prefix;       // prefix sums of weight * minDistances
+};
+} // namespace SESAME
+#endif // SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_KMEANSPPSEEDER_HPP_
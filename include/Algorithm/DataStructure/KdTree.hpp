@@ -0,0 +1,57 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#ifndef SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_KDTREE_HPP_
+#define SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_KDTREE_HPP_
+#include <Algorithm/DataStructure/Point.hpp>
+#include <vector>
+namespace SESAME {
+
+/**
+ * k-nearest neighbour and fixed-radius index over a static subset of
+ * points. Every inner node splits its points at the median of the dim with
+ * the largest spread, so distances to a whole subtree are bounded by the
+ * distance to the split plane and most subtrees are never visited. Queries
+ * are read-only and may run concurrently.
+ */
+class KdTree {
+public:
+  constexpr static const int LEAF_SIZE = 8;
+
+  /**
+   * Index the points whose indices in points are listed in members
+   */
+  KdTree(const std::vector<PointPtr> &points, const std::vector<int> &members);
+  size_t size() const { return ids.size(); }
+  /**
+   * Collect the distances from query to its k nearest members, nearest first,
+   * leaving out the member whose index is skip (-1 leaves out none)
+   */
+  void nearest(const PointPtr &query, int k, int skip,
+               std::vector<double> &dists) const;
+  /**
+   * Collect the indices of all members within radius (inclusive) of query,
+   * in increasing order
+   */
+  void rangeQuery(const PointPtr &query, double radius,
+                  std::vector<int> &members) const;
+
+private:
+  struct Node {
+    int begin, end; // range of the node's members in ids
+    int dim = -1;   // split dim, -1 for a leaf
+    double split = 0;
+    int left = -1, right = -1;
+  };
+  int dim = 0;
+  std::vector<Node> nodes;          // nodes[0] is the root
+  std::vector<int> ids;             // member indices in tree order
+  std::vector<double> coordinates;  // one row of dim values per member
+  int build(int begin, int end);
+  void search(int node, const double *query, int k, int skip,
+              std::vector<double> &dists) const;
+  void searchRange(int node, const double *query, double radiusSquared,
+                   std::vector<int> &members) const;
+};
+} // namespace SESAME
+#endif // SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_KDTREE_HPP_
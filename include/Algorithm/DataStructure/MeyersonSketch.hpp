@@ -82,6 +82,13 @@ public:
 std::pair<double, double>
 guess_optimum_range_bounds(Random *r, const std::vector<PointPtr> &samples,
                            int window_size, int num_samples, int k);
+// Same as above, with the samples solved in parallel on workers threads and
+// the random source of each sample seeded from seeds
+std::pair<double, double>
+guess_optimum_range_bounds(const std::vector<int> &seeds,
+                           const std::vector<PointPtr> &samples,
+                           int window_size, int num_samples, int k,
+                           int workers);
 
 } // namespace SESAME
 
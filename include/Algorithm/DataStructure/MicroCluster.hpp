@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 namespace SESAME {
@@ -38,6 +39,13 @@ public:
   int createTime;
   int lastUpdateTime;
   bool visited;
+  // Stamp of the contents, unique over all micro clusters. Modifications only
+  // set changed, the stamp is renewed by stamp() when a snapshot is taken. A
+  // copy keeps the stamp, so equal stamps of stamped micro clusters mean equal
+  // contents; snapshots use this to share unchanged copies. Code writing the
+  // fields directly must touch()
+  uint64_t version = 0;
+  bool changed = true;
 
   // TODO 1. Need to subtract Base class of CF vector when all cf-vector
   // based-algorithms have been implemented
@@ -76,6 +84,11 @@ public:
   double getDistance(MicroClusterPtr other); // DBStream
   void move();                               // DBStream
   void decayWeight(double decayFactor);
+  void touch() { changed = true; }
+  /**
+   * Renew the version if the micro cluster changed since it was last stamped
+   */
+  void stamp();
   SESAME::MicroClusterPtr copy();
 
 private:
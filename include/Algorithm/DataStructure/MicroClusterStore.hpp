@@ -0,0 +1,62 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#ifndef SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_MICROCLUSTERSTORE_HPP_
+#define SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_MICROCLUSTERSTORE_HPP_
+#include <Algorithm/DataStructure/MicroCluster.hpp>
+#include <Algorithm/DataStructure/Point.hpp>
+#include <vector>
+namespace SESAME {
+
+/**
+ * A set of micro clusters whose centroids are mirrored in one row-major
+ * matrix, so that the nearest centroid of a point is found by a single pass
+ * over contiguous memory instead of chasing a pointer per micro cluster.
+ * Removal swaps the last micro cluster into the freed slot, so the order of
+ * the micro clusters is not preserved.
+ */
+class MicroClusterStore {
+public:
+  std::vector<MicroClusterPtr> microClusters;
+
+  MicroClusterStore();
+  explicit MicroClusterStore(int dim);
+  size_t size() const { return microClusters.size(); }
+  bool empty() const { return microClusters.empty(); }
+  const MicroClusterPtr &at(size_t index) const {
+    return microClusters.at(index);
+  }
+  void add(const MicroClusterPtr &microCluster);
+  /**
+   * Copy the centroid of the micro cluster at index into the matrix again,
+   * after the micro cluster absorbed a point
+   */
+  void syncCentroid(size_t index);
+  /**
+   * Remove the micro cluster at index by moving the last one into its slot
+   */
+  void remove(size_t index);
+  /**
+   * Remove all micro clusters for which remove(microCluster) returns true
+   */
+  template <typename Predicate> void removeIf(Predicate &&remove) {
+    size_t index = 0;
+    while (index < microClusters.size()) {
+      if (remove(microClusters[index]))
+        this->remove(index);
+      else
+        index++;
+    }
+  }
+  /**
+   * @return the index of the micro cluster whose centroid is nearest to the
+   * point, or size() if the store is empty
+   */
+  size_t nearest(const PointPtr &point) const;
+
+private:
+  int dim = 0;
+  std::vector<double> centroids; // size() rows of dim values
+};
+} // namespace SESAME
+#endif // SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_MICROCLUSTERSTORE_HPP_
@@ -0,0 +1,41 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#ifndef SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_POINTGRIDINDEX_HPP_
+#define SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_POINTGRIDINDEX_HPP_
+#include <Algorithm/DataStructure/Point.hpp>
+#include <cstdint>
+#include <vector>
+namespace SESAME {
+
+/**
+ * Fixed-radius neighbour index over a static set of points. The points are
+ * bucketed into cells of width radius over the (at most GRID_DIMS) dims with
+ * the largest spread, and kept sorted by cell. Any point within radius of a
+ * query lies in one of the 3^GRID_DIMS cells around the query's cell, so only
+ * those cells are scanned. Queries are read-only and may run concurrently.
+ */
+class PointGridIndex {
+public:
+  constexpr static const int GRID_DIMS = 3;
+
+  PointGridIndex(const std::vector<PointPtr> &points, double radius);
+  /**
+   * Collect the indices of all points within radius (inclusive) of the point
+   * at index, itself included, in increasing order
+   */
+  void rangeQuery(int index, std::vector<int> &neighbours) const;
+
+private:
+  int dim;
+  double radius;
+  std::vector<double> coordinates; // one row of dim values per point
+  std::vector<int> gridDims;       // dims the cells are laid over
+  std::vector<double> origin;      // minimum value of each grid dim
+  std::vector<uint64_t> keys;      // cell key of each point, sorted
+  std::vector<int> order;          // point indices in the order of keys
+  uint64_t cellKey(const int *cell) const;
+  void cellOf(int index, int *cell) const;
+};
+} // namespace SESAME
+#endif // SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_POINTGRIDINDEX_HPP_
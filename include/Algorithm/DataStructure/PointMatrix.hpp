@@ -0,0 +1,33 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#ifndef SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_POINTMATRIX_HPP_
+#define SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_POINTMATRIX_HPP_
+#include <Algorithm/DataStructure/Point.hpp>
+#include <vector>
+namespace SESAME {
+
+/**
+ * Copy the features of the points into one row of dim values per point, the
+ * flat layout the distance loops of the indexes and refinements scan
+ */
+std::vector<double> flattenPoints(const std::vector<PointPtr> &points, int dim);
+/**
+ * Same as above, for the points whose indices in points are listed in members
+ */
+std::vector<double> flattenPoints(const std::vector<PointPtr> &points,
+                                  const std::vector<int> &members, int dim);
+
+/**
+ * Squared Euclidean distance between two rows of dim values
+ */
+inline double squaredDistance(const double *a, const double *b, int dim) {
+  double dist = 0;
+  for (int j = 0; j < dim; j++) {
+    double diff = a[j] - b[j];
+    dist += diff * diff;
+  }
+  return dist;
+}
+} // namespace SESAME
+#endif // SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_POINTMATRIX_HPP_
@@ -34,8 +34,20 @@ public:
   QueueOrderSnapshotPtr: Data Structure representing orders
   **/
   Snapshot(MicroClusters &otherMicroClusters, int elapsedTime);
+  /**
+   * Copy-on-write snapshot: micro clusters unchanged since the previous
+   * snapshot (same version) share its copies instead of being copied again.
+   * The micro clusters of such a snapshot are shared and must not be modified
+   */
+  Snapshot(MicroClusters &otherMicroClusters, int elapsedTime,
+           const SnapshotPtr &previous);
   ~Snapshot();
-  static SnapshotPtr findSnapshot(QueueOrderSnapshot orderSnapShots,
+  /**
+   * @return the stored snapshot closest to landmarkTime (the later one on a
+   * tie), or nullptr if no snapshot is stored. The snapshot is shared with
+   * the pyramidal window and is read-only
+   */
+  static SnapshotPtr findSnapshot(const QueueOrderSnapshot &orderSnapShots,
                                   int landmarkTime, int currentElapsedTime,
                                   unsigned int currentOrder);
 
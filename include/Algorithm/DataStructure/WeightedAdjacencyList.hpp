@@ -10,52 +10,18 @@
 #include "Algorithm/WindowModel/DampedWindow.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
-#include <unordered_map>
+#include <vector>
 
 namespace SESAME {
-struct MicroClusterPair;
-typedef std::shared_ptr<MicroClusterPair> MicroClusterPairPtr;
-struct MicroClusterPair {
-  MicroClusterPtr microCluster1;
-  MicroClusterPtr microCluster2;
-  MicroClusterPair(MicroClusterPtr microCluster1,
-                   MicroClusterPtr microCluster2) {
-    this->microCluster1 = microCluster1->copy();
-    this->microCluster2 = microCluster2->copy();
-  }
-  // bool operator==(const MicroClusterPair &other) const;
-};
-
-struct KeyHasher {
-  std::size_t operator()(const MicroClusterPair &microClusterPair) const {
-    return (std::hash<int>()(microClusterPair.microCluster1->id.front())) ^
-           (std::hash<int>()(microClusterPair.microCluster2->id.front()));
-  }
-};
-
-struct EqualKey {
-  bool operator()(const MicroClusterPair &MCPair1,
-                  const MicroClusterPair &MCPair2) const {
-    if (MCPair1.microCluster1->id.front() ==
-            MCPair2.microCluster1->id.front() &&
-        MCPair1.microCluster2->id.front() == MCPair2.microCluster2->id.front())
-      return true;
-    if (MCPair1.microCluster1->id.front() ==
-            MCPair2.microCluster2->id.front() &&
-        MCPair1.microCluster2->id.front() == MCPair2.microCluster1->id.front())
-      return true;
-    return false;
-  }
-};
 
-class AdjustedWeight;
-typedef std::shared_ptr<AdjustedWeight> AdjustedWeightPtr;
 class AdjustedWeight {
 public:
-  double weight;
+  double weight = 0;
   int updateTime = 0; //
-  timespec updateTime0;
+  timespec updateTime0{};
+  AdjustedWeight() = default;
   AdjustedWeight(double weight, int pointTime,
                  timespec pointTime0); // clock_t pointTime
   void add(int startTime, double decayValue);
@@ -63,9 +29,89 @@ public:
   double getCurrentWeight(double decayFactor);
 };
 
-typedef std::unordered_map<MicroClusterPair, AdjustedWeightPtr, KeyHasher,
-                           EqualKey>
-    WeightedAdjacencyList;
-typedef std::pair<MicroClusterPair, AdjustedWeightPtr> DensityGraph;
+/**
+ * Shared density graph of DBStream: maps an unordered pair of micro cluster
+ * ids to the adjusted weight of the pair. The pair is packed into one 64-bit
+ * key (smaller id in the high half) and stored inline with its weight in an
+ * open-addressing table with linear probing, so updating an edge allocates
+ * nothing. The edges of a removed micro cluster are not looked up: they stay
+ * in the table until their own expiry events drop them.
+ */
+class WeightedAdjacencyList {
+public:
+  typedef uint64_t Key;
+
+  /**
+   * @return the key of the unordered pair (id1, id2); ids are non-negative
+   */
+  static Key pairKey(int id1, int id2) {
+    if (id1 > id2)
+      std::swap(id1, id2);
+    return ((Key)(uint32_t)id1 << 32) | (uint32_t)id2;
+  }
+  static int firstId(Key key) { return (int)(key >> 32); }
+  static int secondId(Key key) { return (int)(key & 0xffffffffu); }
+
+  /**
+   * @return the weight of the pair (id1, id2), or nullptr if there is no edge
+   */
+  AdjustedWeight *find(int id1, int id2);
+
+  /**
+   * Insert the pair (id1, id2), which must not be in the graph yet
+   * @return the stored weight of the new edge
+   */
+  AdjustedWeight &insert(int id1, int id2, const AdjustedWeight &weight);
+
+  /**
+   * Remove the pair (id1, id2) if it is in the graph
+   */
+  void erase(int id1, int id2);
+
+  size_t size() const { return used; }
+  bool empty() const { return used == 0; }
+  void clear();
+
+  /**
+   * Call visit(id1, id2, weight) for every edge, with id1 < id2
+   */
+  template <typename Visitor> void forEach(Visitor &&visit) {
+    for (auto &slot : slots)
+      if (slot.key < DELETED)
+        visit(firstId(slot.key), secondId(slot.key), slot.weight);
+  }
+
+  /**
+   * Remove every edge for which remove(id1, id2, weight) returns true
+   */
+  template <typename Predicate> void eraseIf(Predicate &&remove) {
+    for (auto &slot : slots)
+      if (slot.key < DELETED &&
+          remove(firstId(slot.key), secondId(slot.key), slot.weight)) {
+        slot.key = DELETED;
+        used--;
+        deleted++;
+      }
+  }
+
+private:
+  // Packed ids are below 2^63, so the top keys are free to mark slots
+  constexpr static const Key EMPTY = ~(Key)0;
+  constexpr static const Key DELETED = EMPTY - 1;
+  struct Slot {
+    Key key = EMPTY;
+    AdjustedWeight weight;
+  };
+  std::vector<Slot> slots; // capacity is zero or a power of two
+  size_t used = 0;         // slots holding an edge
+  size_t deleted = 0;      // slots holding a tombstone
+
+  size_t homeSlot(Key key) const {
+    // Fibonacci hashing spreads consecutive ids over the table
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (slots.size() - 1);
+  }
+  size_t slotOf(Key key) const;
+  void rehash(size_t capacity);
+};
 } // namespace SESAME
 #endif // SESAME_INCLUDE_ALGORITHM_DATASTRUCTURE_WEIGHTEDADJACENCYLIST_HPP_
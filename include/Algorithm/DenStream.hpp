@@ -6,6 +6,8 @@
 
 #include "Algorithm/Algorithm.hpp"
 #include "Algorithm/DataStructure/MicroCluster.hpp"
+#include "Algorithm/DataStructure/MicroClusterStore.hpp"
+#include "Algorithm/DataStructure/PointGridIndex.hpp"
 #include "Algorithm/OfflineRefinement/DBSCAN.hpp"
 #include "Algorithm/WindowModel/DampedWindow.hpp"
 #include "Utils/BenchmarkUtils.hpp"
@@ -36,8 +38,8 @@ public:
   std::shared_ptr<DBSCAN>
       dbscan; // used for initialization and offline re-clustering
   DampedWindowPtr dampedWindow;
-  std::vector<MicroClusterPtr> pMicroClusters;
-  std::vector<MicroClusterPtr> oMicroClusters;
+  MicroClusterStore pMicroClusters;
+  MicroClusterStore oMicroClusters;
   int startTime;
   int pointArrivingTime; // clock_t
   int lastPointTime;
@@ -54,24 +56,22 @@ public:
   double getMinWeight() { return minWeight; };
 
 private:
+  // Number of buffered points whose ε-neighbourhoods are found in one parallel
+  // pass during initialization; bounds the memory held by the neighbourhoods
+  constexpr static const int INIT_BLOCK = 256;
   bool isInitial = false;
   vector<PointPtr> initialBuffer;
   double minWeight;
   void Init(vector<PointPtr> &initData);
   void merge(PointPtr dataPoint);
   void pointsNearCorePoint(vector<PointPtr> &initData,
-                           std::vector<int> pointIndex,
+                           const std::vector<int> &neighbourhood,
+                           std::vector<int> &pointIndex,
                            MicroClusterPtr microCluster);
-  MicroClusterPtr nearestNeighbor(PointPtr dataPoint,
-                                  std::vector<MicroClusterPtr> microClusters);
-  bool mergeToMicroCluster(PointPtr dataPoint,
-                           std::vector<MicroClusterPtr> microClusters);
-  bool mergeToOMicroCluster(PointPtr dataPoint,
-                            std::vector<MicroClusterPtr> microClusters);
+  bool mergeToMicroCluster(PointPtr dataPoint, double decayFactor);
+  bool mergeToOMicroCluster(PointPtr dataPoint, double decayFactor);
   static void microClusterToPoint(std::vector<MicroClusterPtr> &microClusters,
                                   vector<PointPtr> &points);
-  int findIndex(std::vector<MicroClusterPtr> &microClusters,
-                MicroClusterPtr MC);
   // TODO overlap functions with Clustream, may need to remove to utils folder
 };
 } // namespace SESAME
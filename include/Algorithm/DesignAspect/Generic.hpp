@@ -48,11 +48,12 @@ public:
   StreamClustering(const param_t &param);
   ~StreamClustering();
   void Init();
-  void Insert(PointPtr);
+  void Insert(PointPtr) override;
   void RunOnline(PointPtr input);
   void RunOffline(DataSinkPtr ptr);
   void store(std::string output_file, int dim, std::vector<PointPtr> results);
   void OutputOnline(std::vector<PointPtr> &centers) override;
+  void Snapshot() override;
 
 private:
   using Node = typename D::Node;
@@ -68,6 +69,7 @@ private:
   std::vector<PointPtr> online_centers;
   size_t cluster_size_ = 0, outlier_size_ = 0;
   NodePtr InsertOutliers(PointPtr point);
+  void CollectCenters(std::vector<PointPtr> &centers);
 };
 
 template <typename W, typename D, typename O, typename R>
@@ -242,6 +244,7 @@ void StreamClustering<W, D, O, R>::RunOnline(PointPtr input) {
     }
     win_timer.Tock();
   }
+  SnapshotTick();
   lat_timer.Add(input->toa);
 }
 
@@ -289,14 +292,37 @@ template <typename W, typename D, typename O, typename R>
 void StreamClustering<W, D, O, R>::OutputOnline(
     std::vector<PointPtr> &centers) {
   // std::cerr << "Generic OutputOnline: " << d->clusters().size() << std::endl;
-  auto clusters = d->clusters();
-  cluster_size_ += clusters.size();
+  cluster_size_ += d->clusters().size();
   outlier_size_ += outliers_.size();
+  CollectCenters(centers);
+}
+
+template <typename W, typename D, typename O, typename R>
+  requires StreamClusteringConcept<W, D, O, R>
+void StreamClustering<W, D, O, R>::Snapshot() {
+  std::vector<PointPtr> centers;
+  // A coreset tree keeps the coreset it reduced to until it is reset, so only
+  // the coresets of the windows done so far are published
+  if constexpr (std::is_same<D, CoresetTree>::value) {
+    for (auto &center : online_centers)
+      centers.push_back(center->copy());
+  } else {
+    CollectCenters(centers);
+  }
+  Publish(std::move(centers));
+}
+
+template <typename W, typename D, typename O, typename R>
+  requires StreamClusteringConcept<W, D, O, R>
+void StreamClustering<W, D, O, R>::CollectCenters(
+    std::vector<PointPtr> &centers) {
+  auto &clusters = d->clusters();
   for (int i = 0; i < clusters.size(); i++) {
     auto centroid = GenericFactory::New<Point>(param.dim, i);
     for (int j = 0; j < param.dim; j++) {
       centroid->feature[j] = clusters[i]->cf.ls[j] / clusters[i]->cf.num;
     }
+    centroid->setWeight(clusters[i]->cf.num);
     centers.push_back(centroid);
   }
   for (int i = 0; i < outliers_.size(); ++i) {
@@ -304,6 +330,7 @@ void StreamClustering<W, D, O, R>::OutputOnline(
     for (int j = 0; j < param.dim; j++) {
       centroid->feature[j] = outliers_[i]->cf.ls[j] / outliers_[i]->cf.num;
     }
+    centroid->setWeight(outliers_[i]->cf.num);
     centers.push_back(centroid);
   }
 }
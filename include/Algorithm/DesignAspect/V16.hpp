@@ -36,9 +36,6 @@
  * */
 namespace SESAME {
 
-typedef std::unordered_map<DensityGrid, CharacteristicVector, GridKeyHash,
-                           EqualGrid>
-    HashMap;
 class V16 : public Algorithm {
 public:
   int currentTimeStamp = 0;
@@ -58,7 +55,12 @@ public:
   std::vector<int> Coord;
   std::vector<PointPtr> onlineCenters;
   int q = 0;
+  // Ring buffer holding the grid of each point in the sliding window;
+  // windowHead is the slot of the oldest point once the buffer is full
   std::vector<DensityGrid> windowGrid;
+  size_t windowHead = 0;
+  // Clusters that lost grids since the last adjustment
+  std::vector<int> dirtyClusters;
 
   V16(param_t &cmd_params);
   ~V16();
@@ -68,12 +70,15 @@ public:
   void OutputOnline(std::vector<PointPtr> &onlineCenters) override;
 
 private:
+  std::vector<DensityGrid> neighbours; // Scratch space for neighbour grids
   void GridListUpdate(const std::vector<int> &coordinate);
   void initialClustering();
   void adjustClustering();
-  bool adjustLabels();
   bool inspectChangedGrids();
   void RemoveWindowPointFromGrid();
+  void removeGridFromClusters(const DensityGrid &grid, int label);
+  void splitDirtyClusters();
+  static std::vector<GridCluster> gridGroups(const GridCluster &cluster);
   void calculateGridCoord(PointPtr point);
   HashMap adjustForSparseGrid(const DensityGrid &grid,
                               CharacteristicVector characteristicVec,
@@ -36,9 +36,6 @@
  * */
 namespace SESAME {
 
-typedef std::unordered_map<DensityGrid, CharacteristicVector, GridKeyHash,
-                           EqualGrid>
-    HashMap;
 class V9 : public Algorithm {
 public:
   int currentTimeStamp = 0;
@@ -67,10 +64,10 @@ public:
   void RunOffline(DataSinkPtr sinkPtr) override;
 
 private:
+  std::vector<DensityGrid> neighbours; // Scratch space for neighbour grids
   void GridListUpdate(const std::vector<int> &coordinate);
   void initialClustering();
   void adjustClustering();
-  bool adjustLabels();
   bool inspectChangedGrids();
   void calculateGridCoord(PointPtr point);
   HashMap adjustForSparseGrid(const DensityGrid &grid,
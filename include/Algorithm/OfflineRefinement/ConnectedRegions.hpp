@@ -19,7 +19,11 @@ public:
   double alpha;      // intersection factor, alpha
   double min_weight; // minimum weight
   std::vector<std::vector<MicroClusterPtr>> finalClusters;
-  unordered_map<int, std::vector<int>> connecvtivityGraphId;
+  // Micro cluster of each slot of the forest, null once it was removed
+  std::vector<MicroClusterPtr> vertices;
+  unordered_map<int, int> slotOfId; // micro cluster id -> slot
+  std::vector<int> parent;          // union-find forest over the slots
+  std::vector<char> inGraph; // whether the slot is an end of a weighty edge
   ConnectedRegions();
   ConnectedRegions(double alpha, double min_weight);
   void connection(std::vector<MicroClusterPtr> &microClusters,
@@ -27,28 +31,62 @@ public:
   std::vector<PointPtr> ResultsToDataSink();
 
   /**
-   * @Description:  insert vertices and entries into connectivity graph when
-   * micro cluster pair connectivity value greater than the intersection
-   * threshold if the graph has testing micro cluster, add connected strong MC
-   * in the corresponding entries else, create new V,E into the graph
-   * @Param: connectivity graph, micro cluster 1 and 2
+   * @Description: rebuild the forest from scratch over the given micro
+   * clusters, in their order, and every edge of the shared density graph.
+   * This drops the slots of removed micro clusters and undoes the unions of
+   * edges that weakened or were erased since the last rebuild
+   * @Param: micro clusters and weighted adjacency list
    * @Return: void
    */
-  void insertIntoGraph(const std::vector<MicroClusterPtr> &microClusters,
-                       int microClusterId, int OtherId);
-  void insertIntoGraph(const std::vector<MicroClusterPtr> &microClusters,
-                       int microClusterId);
+  void rebuild(const std::vector<MicroClusterPtr> &microClusters,
+               SESAME::WeightedAdjacencyList &weightedAdjacencyList);
   /**
-   * @Description:  findConnectedComponents function visit the existing
-   * connectivity graph and find all connected strong MCs that will finally form
-   * arbitrary-shaped macro clusters each macro cluster will be stored as a
-   * vector of micro clusters, which will be transformed into point that stores
-   * in sink later
-   * @Param: connectivity graph
+   * @Description: give a new micro cluster its own slot at the end of the
+   * forest
+   * @Param: micro cluster
    * @Return: void
    */
-  void
-  findConnectedComponents(const std::vector<MicroClusterPtr> &microClusters);
+  void addVertex(const MicroClusterPtr &microCluster);
+  /**
+   * @Description: leave the slot of a removed micro cluster out of the macro
+   * clusters; its unions stay until the next rebuild
+   * @Param: micro cluster id
+   * @Return: void
+   */
+  void removeVertex(int id);
+  /**
+   * @Description: account for the shared density weight of a micro cluster
+   * pair: if both micro clusters are weighty the pair joins the graph, and if
+   * the connectivity value is greater than the intersection threshold their
+   * trees are merged
+   * @Param: micro cluster id 1 and 2, shared density weight
+   * @Return: void
+   */
+  void link(int id1, int id2, double weight);
+  /**
+   * @Description: find the root of the slot's tree, halving the path on the
+   * way up
+   * @Param: slot of a micro cluster
+   * @Return: slot of the root
+   */
+  int findRoot(int slot);
+  /**
+   * @Description: merge the trees of two slots, whose micro cluster pair
+   * connectivity value is greater than the intersection threshold
+   * @Param: slots of micro cluster 1 and 2
+   * @Return: void
+   */
+  void unite(int slot1, int slot2);
+  /**
+   * @Description:  findConnectedComponents function collects the live slots
+   * of each tree in the forest, every tree forms an arbitrary-shaped macro
+   * cluster. Each macro cluster will be stored as a vector of micro clusters,
+   * in slot order, which will be transformed into point that stores in sink
+   * later. This takes O(K) for K slots
+   * @Param: void
+   * @Return: void
+   */
+  void findConnectedComponents();
 };
 
 } // namespace SESAME
@@ -3,7 +3,9 @@
 //
 #ifndef SESAME_INCLUDE_ALGORITHM_OFFLINECLUSTERING_DBSCAN_HPP_
 #define SESAME_INCLUDE_ALGORITHM_OFFLINECLUSTERING_DBSCAN_HPP_
+#include "Algorithm/DataStructure/KdTree.hpp"
 #include "Algorithm/DataStructure/Point.hpp"
+#include "Algorithm/DataStructure/PointGridIndex.hpp"
 #include "Algorithm/OfflineRefinement/OfflineRefinement.hpp"
 #include "Algorithm/Param.hpp"
 #include "Sinks/DataSink.hpp"
@@ -34,12 +36,12 @@ public:
   void produceResult(std::vector<PointPtr> &input, DataSinkPtr sinkPtr);
 
 private:
-  std::vector<int> calculateCluster(std::vector<PointPtr> &input,
-                                    PointPtr &point) const;
-  int expandCluster(std::vector<PointPtr> &input, PointPtr &point,
-                    int clusterID) const;
+  void cluster(std::vector<PointPtr> &input);
+  int expandCluster(std::vector<PointPtr> &input,
+                    const std::vector<char> &core, int point, int clusterID);
+  void regionQuery(std::vector<PointPtr> &input, int point,
+                   std::vector<int> &neighbours) const;
   static bool judgeCorePoint(PointPtr &point, PointPtr &other);
-  static double calculateEluDistance(PointPtr &point, PointPtr &other);
   // Obtain private members
   unsigned int getTotalPointSize() const { return pointSize; }
   unsigned int getMinimumClusterSize() const { return min_points; }
@@ -49,6 +51,12 @@ private:
   unsigned int min_points;
   int clusterID;
   double epsilon;
+  // Region queries go to the grid in up to PointGridIndex::GRID_DIMS dims,
+  // where its cells cover every dim, and to the kd-tree above that
+  std::shared_ptr<PointGridIndex> grid;
+  std::shared_ptr<KdTree> tree;
+  // region query buffers, reused across queries
+  std::vector<int> clusterSeeds, clusterNeighbors;
 };
 } // namespace SESAME
 #endif // SESAME_INCLUDE_ALGORITHM_OFFLINECLUSTERING_DBSCAN_HPP_
@@ -27,7 +27,7 @@ namespace SESAME {
 class KMeans : public OfflineRefinement {
 public:
   KMeans() {}
-  KMeans(const SesameParam &param) {}
+  KMeans(const SesameParam &param) : pruning(param.kmeans_pruning) {}
   // TODO: use template here
   void Run(SesameParam &param, std::vector<PointPtr> &online_centers,
            DataSinkPtr sinkPtr);
@@ -44,26 +44,20 @@ public:
                    std::vector<PointPtr> &output);
 
 private:
-  // Randomly chooses k centres with kMeans++ distribution
-  double calculateEluDistance(PointPtr &point, PointPtr &center);
-  void calculateClusterCenter(PointPtr &center, std::vector<PointPtr> &group);
+  bool pruning = false; // prune the assignment step with Hamerly's bounds
   void randomSelectCenters(int numberOfCenters, int numberOfInput,
                            std::vector<PointPtr> &input,
                            std::vector<PointPtr> &centers);
+  // Randomly chooses k centres with kMeans++ distribution
   void selectCentersFromWeight(int numberOfCenters, int numberOfInput,
                                std::vector<PointPtr> &input,
                                std::vector<PointPtr> &centers);
-  void groupPointsByCenters(int numberOfCenters, int numberOfInput,
-                            std::vector<PointPtr> &input,
-                            std::vector<PointPtr> &centers,
-                            std::vector<std::vector<PointPtr>> &groups);
-  void adjustClusteringCenters(std::vector<PointPtr> &centers,
-                               std::vector<std::vector<PointPtr>> &groups);
-  void refreshGroup(std::vector<std::vector<PointPtr>> &oldGroups,
-                    std::vector<std::vector<PointPtr>> &newGroups);
-  void checkStopStatus(bool &flag,
-                       std::vector<std::vector<PointPtr>> &oldGroups,
-                       std::vector<std::vector<PointPtr>> &newGroups);
+  void lloydIterations(std::vector<PointPtr> &input,
+                       std::vector<PointPtr> &centers,
+                       std::vector<int> &assignment);
+  void groupByAssignment(std::vector<PointPtr> &input,
+                         std::vector<int> &assignment, int numberOfCenters,
+                         std::vector<std::vector<PointPtr>> &groups);
 };
 } // namespace SESAME
 #endif // SESAME_INCLUDE_ALGORITHM_OFFLINECLUSTERING_KMEANS_HPP_
@@ -0,0 +1,39 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#ifndef SESAME_INCLUDE_ALGORITHM_OFFLINEREFINEMENT_MINIBATCHKMEANS_HPP_
+#define SESAME_INCLUDE_ALGORITHM_OFFLINEREFINEMENT_MINIBATCHKMEANS_HPP_
+
+#include "Algorithm/DataStructure/Point.hpp"
+#include "Algorithm/OfflineRefinement/OfflineRefinement.hpp"
+#include "Algorithm/Param.hpp"
+#include "Sinks/DataSink.hpp"
+
+#include <random>
+#include <vector>
+
+namespace SESAME {
+/**
+ * Weighted mini-batch k-means (Sculley, 2010) over the online centres. Every
+ * centre counts with its weight, and the refinement stops after
+ * mini_batch_iterations steps or once mini_batch_budget_ms has elapsed,
+ * whichever comes first, so its latency does not grow with the number of
+ * online centres beyond the final assignment pass. G17 is G1 with this
+ * refinement in place of KMeans. The settings are read from the param of
+ * every Run, like DBSCAN's.
+ */
+class MiniBatchKMeans : public OfflineRefinement {
+public:
+  MiniBatchKMeans() {}
+  MiniBatchKMeans(const SesameParam &param) {}
+  void Run(SesameParam &param, std::vector<PointPtr> &online_centers,
+           DataSinkPtr sinkPtr);
+  void Run(SesameParam &param, std::vector<PointPtr> &online_centers,
+           std::vector<PointPtr> &results);
+
+private:
+  void refine(SesameParam &param, std::vector<PointPtr> &input,
+              std::vector<int> &assignment);
+};
+} // namespace SESAME
+#endif // SESAME_INCLUDE_ALGORITHM_OFFLINEREFINEMENT_MINIBATCHKMEANS_HPP_
@@ -32,7 +32,8 @@ enum AlgoType {
   G13Stream,
   G14Stream,
   G15Stream,
-  G16Stream
+  G16Stream,
+  G17Stream
 };
 
 extern char const *algo_names[64];
@@ -58,6 +59,8 @@ struct param_t {
   int arr_rate = 0;
   bool time_decay = false;
   size_t coreset_size = 100;
+  int merge_workers = 0; // StreamKM: threads merging coreset buckets in the
+                         // background, 0 runs the unions inline
   int seed = 1;
   bool fast_source = false;
   bool store = true;
@@ -90,7 +93,10 @@ struct param_t {
 
   // used in DBStream
   double radius = 0.1, min_weight, alpha = 0.998;
-  size_t clean_interval = 2500; // also used in timer outlier detection
+  size_t clean_interval = 2500; // decay steps to the weak threshold; also the
+                                // age limit of timer outlier detection
+  size_t rebuild_interval = 0;  // points between rebuilds of the online
+                                // macro clusters, 0 finds them offline only
 
   // used in DStream
   double cm = 5.0, cl = 0.8;
@@ -98,8 +104,13 @@ struct param_t {
 
   // used in design aspect
   bool run_offline = true; // determine whether to run the offline refinement
+  size_t snapshot_interval = 0; // points between two views published for
+                                // Query(), 0 publishes none; DBStream also
+                                // needs rebuild_interval > 0
   bool run_eval = true;
   bool run_cmm = false, run_pur = true, run_nmi = false;
+  size_t cmm_sample_size = 0; // points per ground truth cluster sampled to
+                              // estimate the CMM knn statistics, 0 uses all
   //    bool run_group = true;
   int landmark =
       1000; // this is the index of landmark point[start from 0](determine
@@ -115,11 +126,23 @@ struct param_t {
   int outlier_cap = 5;            // transfer outlier cluster and true cluster
   bool kmeanspp = true; // whether use kmeans++ to initialize the centroids
   int k = 2;            // number of k in kmeans / kmeanspp
+  bool kmeans_pruning = false; // whether kmeans skips the point-centre
+                               // distances that Hamerly's bounds rule out
+  int mini_batch_size = 1024;      // points per mini-batch kmeans step
+  int mini_batch_iterations = 100; // max steps of a mini-batch refinement
+  double mini_batch_budget_ms = 0; // time budget of a mini-batch refinement,
+                                   // 0 bounds it by the steps only
+  bool benne_mini_batch = false; // whether Benne's incremental refinement
+                                 // runs mini-batch kmeans instead of kmeans
+  bool benne_background_refine = false; // whether Benne's incremental
+                                        // refinement runs off the ingest thread
 
   double delta_grid =
       0.2; // The delta parameter used int the grid for guessing the optimum.
   int num_samples = 100; // The number of samples used in the grid for guessing
                          // the optimum.
+  int guess_workers = 0; // The number of threads the grid of guesses is
+                         // sharded over, 0 processes the guesses inline.
 
   size_t num_res = 0;
 
@@ -139,6 +162,7 @@ struct param_t {
     std::cout << "distance_threshold: " << distance_threshold << std::endl;
     std::cout << "seed: " << seed << std::endl;
     std::cout << "coreset_size: " << coreset_size << std::endl;
+    std::cout << "merge_workers: " << merge_workers << std::endl;
     std::cout << "radius: " << radius << std::endl;
     std::cout << "delta: " << delta << std::endl;
     std::cout << "beta: " << beta << std::endl;
@@ -146,6 +170,7 @@ struct param_t {
     std::cout << "alpha: " << alpha << std::endl;
     std::cout << "lambda: " << lambda << std::endl;
     std::cout << "clean_interval: " << clean_interval << std::endl;
+    std::cout << "rebuild_interval: " << rebuild_interval << std::endl;
     std::cout << "min_weight: " << min_weight << std::endl;
     std::cout << "base: " << base << std::endl;
     std::cout << "cm: " << cm << std::endl;
@@ -159,6 +184,7 @@ struct param_t {
     std::cout << "num_online_clusters: " << num_online_clusters << std::endl;
     std::cout << "delta_grid: " << delta_grid << std::endl;
     std::cout << "num_samples: " << num_samples << std::endl;
+    std::cout << "guess_workers: " << guess_workers << std::endl;
     std::cout << "landmark: " << landmark << std::endl;
     std::cout << "sliding: " << sliding << std::endl;
     std::cout << "outlier_distance_threshold: " << outlier_distance_threshold
@@ -168,7 +194,17 @@ struct param_t {
               << std::endl;
     std::cout << "neighbor_distance: " << neighbor_distance << std::endl;
     std::cout << "k: " << k << std::endl;
+    std::cout << "kmeans_pruning: " << kmeans_pruning << std::endl;
+    std::cout << "mini_batch_size: " << mini_batch_size << std::endl;
+    std::cout << "mini_batch_iterations: " << mini_batch_iterations
+              << std::endl;
+    std::cout << "mini_batch_budget_ms: " << mini_batch_budget_ms << std::endl;
+    std::cout << "benne_mini_batch: " << benne_mini_batch << std::endl;
+    std::cout << "benne_background_refine: " << benne_background_refine
+              << std::endl;
     std::cout << "run_offline: " << run_offline << std::endl;
+    std::cout << "snapshot_interval: " << snapshot_interval << std::endl;
+    std::cout << "cmm_sample_size: " << cmm_sample_size << std::endl;
     std::cout << "obj: " << obj << std::endl;
     std::cout << "queue_size_threshold: " << benne_threshold.queue_size
               << std::endl;
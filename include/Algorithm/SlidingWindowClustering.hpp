@@ -5,7 +5,11 @@
 #include "Algorithm/Param.hpp"
 #include "Utils/Random.hpp"
 
-#include <list>
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <future>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -13,6 +17,13 @@ namespace SESAME {
 void k_means_plus_plus(Random *r,
                        const std::vector<std::pair<PointPtr, double>> &instance,
                        int32_t k, std::vector<int32_t> *centers, double *cost);
+// Solves num_samples k-means++ instances of window_size samples each on
+// workers threads and returns their positive costs. Instance i draws only from
+// seeds[i], so the costs do not depend on the number of workers.
+std::vector<double> cost_samples(const std::vector<int> &seeds,
+                                 const std::vector<PointPtr> &samples,
+                                 int window_size, int num_samples, int k,
+                                 int workers);
 
 // Class that handles the time stamps of a sliding window. The timestamps start
 // from 0.
@@ -46,6 +57,11 @@ private:
 // insertion are inserted in increasing order. This can be used to keep track of
 // the number of items inserted in a bucket after a certain tiem or to keep
 // track of the total cost of the bucket.
+// The entries are kept in a vector ordered by time, each holding the total
+// inserted before it, so that the weight after an entry is the current total
+// minus its base and an insertion does not touch the older entries. The
+// entries are compacted whenever their number has doubled since the last
+// compaction; in between, the extra entries only make the estimate finer.
 class ApproxTimeCountKeeper {
 public:
   // Epsilon is the approximation error allowed (i.e., we allow 1+epsilon).
@@ -56,59 +72,65 @@ public:
 
   // Increase the count by 'how_much' at time 'time'.
   void increase_total(const int64_t time, const double how_much) {
-    for (auto &time_count : time_counts_) {
-      assert(time_count.first < time);
-      time_count.second += how_much;
-    }
-
-    time_counts_.push_back(std::make_pair(time, how_much));
-
-    auto it = time_counts_.begin();
-    // Compact indices if they are not too different.
-    while (true) {
-      auto it2 = it;
-      // Move twice ahead if possible.
-      if (it2 == time_counts_.end()) {
-        break;
-      }
-      it2++;
-      if (it2 == time_counts_.end()) {
-        break;
-      }
-      auto it_middle = it2;
-      it2++;
-      if (it2 == time_counts_.end()) {
-        break;
-      }
-      // Check if need to remove middle
-      if (it->second <= (1.0 + epsilon_) * it2->second) {
-        it_middle = time_counts_.erase(it_middle);
-        it = it_middle;
-      } else {
-        ++it;
-      }
+    assert(time_bases_.empty() || time_bases_.back().first < time);
+    time_bases_.push_back(std::make_pair(time, total_));
+    total_ += how_much;
+    if (time_bases_.size() >= 2 * compacted_size_) {
+      compact();
+      compacted_size_ = std::max(kMinCompactedSize, time_bases_.size());
     }
   }
 
   // Returns a 1+epsilon estimate of the total weight added to the counter after
   // begin_time.
   double total_after_time(const int64_t begin_time) const {
-    double count = time_counts_.front().second;
-    for (const auto &time_count : time_counts_) {
-      if (time_count.first <= begin_time) {
-        count = time_count.second;
-      }
+    // The last entry at or before begin_time, or the first entry
+    auto it = std::upper_bound(
+        time_bases_.begin(), time_bases_.end(), begin_time,
+        [](int64_t time, const std::pair<int64_t, double> &time_base) {
+          return time < time_base.first;
+        });
+    if (it != time_bases_.begin()) {
+      --it;
     }
-    return count;
+    return total_ - it->second;
   }
 
   // Returns the count at 0.
-  double count_at_0() const { return time_counts_.front().second; }
+  double count_at_0() const { return total_ - time_bases_.front().second; }
 
 private:
-  std::list<std::pair<int64_t, double>> time_counts_;
+  // Remove the middle entry of three consecutive entries if the counts of the
+  // outer ones are within 1+epsilon, scanning once from the oldest entry.
+  void compact() {
+    size_t size = time_bases_.size();
+    if (size < 3) {
+      return;
+    }
+    size_t kept = 0, next = 1;
+    while (next + 1 < size) {
+      if (total_ - time_bases_[kept].second <=
+          (1.0 + epsilon_) * (total_ - time_bases_[next + 1].second)) {
+        time_bases_[++kept] = time_bases_[next + 1];
+        next += 2;
+      } else {
+        time_bases_[++kept] = time_bases_[next];
+        next += 1;
+      }
+    }
+    while (next < size) {
+      time_bases_[++kept] = time_bases_[next++];
+    }
+    time_bases_.resize(kept + 1);
+  }
+
+  // Insertion time and total inserted before it, ordered by time.
+  std::vector<std::pair<int64_t, double>> time_bases_;
+  double total_ = 0.0;
+  size_t compacted_size_ = kMinCompactedSize;
   // Approximation error.
   double epsilon_;
+  static constexpr size_t kMinCompactedSize = 4;
 };
 
 // This is the class that has to be implemented for a sliding window summary
@@ -667,12 +689,18 @@ private:
 //  window which is the window size
 //  begin grid which is used for the begin of the grid
 //  end grid which is the end of the grid.
+//  workers which is the number of threads the grid of guesses is sharded
+//  over, 0 processes every point on every guess in turn.
+// With workers > 0 every guess draws from its own random source, seeded from
+// r, and points are buffered and fed to the guesses in batches, one guess per
+// thread at a time. The result then depends on the seed only, not on the
+// number of workers.
 template <typename SummaryAlg> class FrameworkAlg {
 public:
   FrameworkAlg(Random *r, int64_t window, int32_t k, double delta,
-               double begin_grid, double end_grid)
+               double begin_grid, double end_grid, int32_t workers = 0)
       : r(r), window_(window), k_(k), delta_(delta), begin_grid_(begin_grid),
-        end_grid_(end_grid), window_handler_(window) {
+        end_grid_(end_grid), window_handler_(window), workers_(workers) {
     assert(delta > 0);
     assert(begin_grid < end_grid);
     assert(window_ > 1);
@@ -680,10 +708,17 @@ public:
     // Initializes the summary thresholds.
     double lambda = begin_grid_;
     while (lambda <= end_grid_ * (1.0 + delta)) {
-      threshold_algs_.push_back(
-          OneThresholdsPairSummaryAlg<SummaryAlg>(r, window_, k_, lambda));
+      Random *guess_r = r;
+      if (workers_ > 0) {
+        guess_randoms_.push_back(
+            std::make_unique<Random>(r->random_uniform(0, INT_MAX)));
+        guess_r = guess_randoms_.back().get();
+      }
+      threshold_algs_.push_back(OneThresholdsPairSummaryAlg<SummaryAlg>(
+          guess_r, window_, k_, lambda));
       lambda *= (1 + delta);
     }
+    batch_.reserve(kBatchSize);
   }
   // Disllow copy and assign.
   FrameworkAlg(FrameworkAlg const &) = delete;
@@ -692,13 +727,35 @@ public:
   // Processes a point.
   void process_point(PointPtr point) {
     window_handler_.next();
+    if (workers_ > 0) {
+      batch_.push_back(point);
+      if (batch_.size() == kBatchSize) {
+        flush();
+      }
+      return;
+    }
     for (auto &threshold_alg : threshold_algs_) {
       threshold_alg.process_point(point);
     }
   }
 
+  // Feeds the buffered points to all guesses, the guesses in parallel.
+  void flush() {
+    if (batch_.empty()) {
+      return;
+    }
+#pragma omp parallel for num_threads(workers_) schedule(dynamic)
+    for (size_t i = 0; i < threshold_algs_.size(); i++) {
+      for (const auto &point : batch_) {
+        threshold_algs_[i].process_point(point);
+      }
+    }
+    batch_.clear();
+  }
+
   // Outputs the solution and its cost.
   void solution(vector<PointPtr> *solution, double *value) {
+    flush();
     // Contrary to the simplified version in the main body of the paper, the
     // algorithm considers any valid solution (i.e. computer over the entire
     // window) and outputs the one with the lowest estimate of cost, this only
@@ -793,16 +850,34 @@ private:
   const double end_grid_;
   SlidingWindowHandler window_handler_;
   std::vector<OneThresholdsPairSummaryAlg<SummaryAlg>> threshold_algs_;
+  const int32_t workers_;
+  std::vector<std::unique_ptr<Random>> guess_randoms_;
+  std::vector<PointPtr> batch_;
+  // Number of points buffered before they are fed to the guesses.
+  static constexpr size_t kBatchSize = 256;
 };
 
 class SlidingWindowClustering : public Algorithm {
 private:
   Random r;
+  // Points of the samples used to guess the bounds of the optimum, and the
+  // points waiting for the framework in order of arrival. At most one window
+  // of points waits while the bounds are guessed in the background; once the
+  // framework is built, every new point drains a slice of the backlog.
   std::vector<PointPtr> samples;
+  std::deque<PointPtr> pending;
+  static constexpr size_t drain_slice = 8;
+  std::future<std::pair<double, double>> bounds;
   bool has_sampled = false;
   std::shared_ptr<FrameworkAlg<KMeansSummary>> framework;
   int count = 0;
 
+  // Builds the framework from the guessed bounds and queues the samples ahead
+  // of the buffered points.
+  void build_framework();
+  // Feeds the framework up to max_points of the buffered points.
+  void drain_pending(size_t max_points);
+
 public:
   SlidingWindowClustering(param_t &cmd_params);
 
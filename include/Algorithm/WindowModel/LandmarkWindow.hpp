@@ -10,15 +10,20 @@
 
 #include "Algorithm/DataStructure/Point.hpp"
 #include "Algorithm/DataStructure/Snapshot.hpp"
-#include "Algorithm/DataStructure/TreeNode.hpp"
 #include "Algorithm/WindowModel/WindowModel.hpp"
 #include "Timer/TimeMeter.hpp"
 
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
 #include <vector>
 
 namespace SESAME {
@@ -34,54 +39,72 @@ public:
   private:
     param_t param;
 
-  public:
-    CoresetTree(const param_t &param) : param(param) {}
     /**
-     * initalizes root as a treenode with the union of setA and setB as pointset
-     * and centre as centre
-     * @param root
-     * @param setA
-     * @param setB
-     * @param n_1
-     * @param n_2
-     * @param centre
-     * @param centreIndex
+     * Node of the coreset tree. The nodes of a union live in one arena that
+     * is reused by the next union, and refer to each other and to their
+     * points by index instead of by pointer
      */
-    void constructRoot(TreeNodePtr root, std::vector<PointPtr> &setA,
-                       std::vector<PointPtr> &setB, int n_1, int n_2,
-                       PointPtr centre, int centreIndex);
+    struct Node {
+      int begin, end; // range of the node's points in order
+      int centre;     // union index of the node's centre
+      int parent, lc, rc;
+      double cost;
+    };
+    std::vector<Node> nodes;
+    // Per union point: its centroid coordinates (dim values per point), its
+    // weight and the coreset centre it is assigned to
+    int dim = 0;
+    std::vector<double> centroids;
+    std::vector<double> weights;
+    std::vector<int> assignment;
+    // Union indices grouped by leaf, each node covering one range
+    std::vector<int> order;
+    std::vector<int> scratch;
+    // Union index of each chosen centre, -1 for a dummy centre
+    std::vector<int> centreOf;
+    // Own generator of a tree merging in the background; an unseeded tree
+    // draws from the shared genrand stream
+    bool seeded = false;
+    std::mt19937 generator;
+
+    long randomInt31();
+    double randomReal3();
 
     /**
-    Constructs a coreset of size k from the union of setA and setB
+     * Squared distance between the centroids of two union points
+     */
+    double distance(int point, int centre) const;
+    /**
+     * Computes and stores the cost of the node: the weighted squared distance
+     * of its points to its centre
+     */
+    void treeNodeTargetFunctionValue(Node &node) const;
+    /**
+    selects a leaf node (using the kMeans++ distribution)
     **/
-    void unionTreeCoreset(int k, int n_1, int n_2, std::vector<PointPtr> &setA,
-                          std::vector<PointPtr> &setB,
-                          std::vector<PointPtr> &centres);
-    void freeTree(TreeNodePtr root);
-    bool treeFinished(TreeNodePtr root);
-    bool isLeaf(TreeNodePtr node);
+    int selectNode();
+    int chooseCentre(int node);
+    double treeNodeSplitCost(int node, int centre) const;
+    /**
+    splits the node and creates two child nodes (one with the old centre and
+    one with the new one)
+    **/
+    void split(int node, int newCentre, int newCentreIndex);
 
+  public:
+    CoresetTree(const param_t &param) : param(param) {}
     /**
-     * Computes the target function value of the n points of the treenode.
-     * Differs from the function "targetFunctionValue" in three things:
-     * 1. only the centre of the treenode is used as a centre
-     * 2. works on arrays of pointers instead on arrays of points
-     * 3. stores the cost in the treenode
-     * @param node
+     * Give the tree its own generator, so that it can build coresets on
+     * another thread without touching the shared genrand stream
      */
-    void treeNodeTargetFunctionValue(TreeNodePtr node);
+    void seed(unsigned long seed);
 
     /**
-    selects a leaf node (using the kMeans++ distribution)
+    Constructs a coreset of size k from the union of setA and setB
     **/
-    TreeNodePtr selectNode(TreeNodePtr root);
-    PointPtr chooseCentre(TreeNodePtr node);
-    double treeNodeCostOfPoint(TreeNodePtr node, PointPtr p);
-    double treeNodeSplitCost(TreeNodePtr node, PointPtr CenterA,
-                             PointPtr CenterB);
-    void split(TreeNodePtr parent, PointPtr newCentre, int newCentreIndex);
-    PointPtr determineClosestCentre(PointPtr point, PointPtr centreA,
-                                    PointPtr centreB);
+    void unionTreeCoreset(int k, int n_1, int n_2, std::vector<PointPtr> &setA,
+                          std::vector<PointPtr> &setB,
+                          std::vector<PointPtr> &centres);
   };
   /**
   DataStructure representing a single window
@@ -104,6 +127,49 @@ public:
   WindowManager windowManager;
   TimeMeter timerMeter;
   CoresetTreePtr tree;
+
+  /**
+   * Asynchronous merge-reduce. With mergeWorkers > 0 a full first window is
+   * handed over as a pending coreset, and the unions of the cascade run on a
+   * fixed pool of mergeWorkers threads while points keep arriving in a fresh
+   * first window. pendingCoresets[i] stands in for the points of window i.
+   * The cascade is decided on the ingest thread and every union seeds its own
+   * generator from the seed and its sequence number, so the coresets depend
+   * on the seed but not on timing. The pool takes unions in carry order, and
+   * a union only waits for unions queued before it, so a busy pool never
+   * waits on a union nobody has started
+   */
+  typedef std::shared_future<std::vector<PointPtr>> PendingCoreset;
+  int mergeWorkers = 0;
+  unsigned long mergeSeed = 0, mergeCount = 0;
+  std::vector<PendingCoreset> pendingCoresets;
+  std::deque<PendingCoreset> mergesInFlight;
+  std::vector<std::thread> mergeThreads;
+  std::deque<std::packaged_task<std::vector<PointPtr>()>> mergeQueue;
+  std::mutex mergeMutex;
+  std::condition_variable mergeReady;
+  bool mergeStop = false;
+  ~LandmarkWindow();
+  void initAsyncMerge(int workers, unsigned long seed);
+  /**
+   * Hand the full first window over to the asynchronous cascade
+   */
+  void spillAsync();
+  PendingCoreset mergeAsync(PendingCoreset setA, PendingCoreset setB);
+  /**
+   * Run queued unions until the window is destroyed
+   */
+  void mergeWorker();
+  /**
+   * Wait for all pending unions and store their coresets in the windows
+   */
+  void finishAsyncMerge();
+  /**
+   * Overwrite the point in slot with a copy of source. The point already in
+   * the slot is reused when nothing else refers to it, which keeps buckets
+   * and coresets from allocating once they are warm
+   */
+  static void assignPoint(PointPtr &slot, const Point &source);
   /**
    * initialize windows in the window manager.
    * @param dim
@@ -142,6 +208,9 @@ public:
   Data Structure representing all orders of snapshots
    **/
   SESAME::QueueOrderSnapshot orderSnapShots;
+  // The last stored snapshot, whose unchanged micro clusters the next one
+  // shares
+  SnapshotPtr latestSnapshot;
   struct PyramidalWindow {
     unsigned int time_interval; // time interval of pyramidal window
     unsigned int currentOrder;  // the biggest order T of snapshots
@@ -5,11 +5,14 @@
 #ifndef SESAME_INCLUDE_EVALUATION_CMM_HPP_
 #define SESAME_INCLUDE_EVALUATION_CMM_HPP_
 
+#include "Algorithm/DataStructure/KdTree.hpp"
 #include "Algorithm/DataStructure/Point.hpp"
 #include "Algorithm/Param.hpp"
 
 #include <atomic>
 #include <map>
+#include <memory>
+#include <random>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -133,17 +136,31 @@ private:
   /** average deviation of knn distance of all points*/
   double knnDevAvg = 0;
 
+public:
+  // Points of one ground truth cluster and their knn statistics
   struct Cluster {
     std::unordered_set<int> points;
     std::vector<int> vpoints;
-    std::atomic<double> knnMeanAvg = 0.0, knnDevAvg = 0.0;
+    double knnMeanAvg = 0.0, knnDevAvg = 0.0;
+    /** half width of the 95% confidence interval of knnMeanAvg, 0 if exact */
+    double knnMeanBound = 0.0;
+    std::unique_ptr<KdTree> tree; // built on first use
     void Insert(int i) {
       points.insert(i);
       vpoints.push_back(i);
     }
-    void CalcKnn(int k, const std::vector<PointPtr> &inputs);
+    const KdTree &Tree(const std::vector<PointPtr> &inputs);
+    double KnnDist(int i, const std::vector<PointPtr> &inputs);
+    void SetConn(int i, const std::vector<PointPtr> &inputs) const;
+    void CalcKnn(int k, const std::vector<PointPtr> &inputs, size_t sampleSize,
+                 std::mt19937 &rng, std::vector<char> &knnKnown);
   };
+
+private:
   std::unordered_map<int, Cluster> clusters;
+  // Whether the knn distance and connectivity of each input are computed;
+  // with sampling the others are computed on first use
+  std::vector<char> knnKnown;
   std::map<int, int> matchMap;
   double cmm;
 
@@ -153,6 +170,7 @@ public:
                   const std::vector<PointPtr> &predicts);
   void AnalyseGT(const std::vector<PointPtr> &inputs,
                  const std::vector<PointPtr> &predicts, bool enableClassMerge);
+  double Conn(int, const std::vector<PointPtr> &);
   double CalcConn(int, const std::vector<PointPtr> &);
   double CalcConn(int, int, const std::vector<PointPtr> &);
   void CalcMatch(const std::vector<PointPtr> &inputs,
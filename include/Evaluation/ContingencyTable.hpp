@@ -0,0 +1,41 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#ifndef SESAME_INCLUDE_EVALUATION_CONTINGENCYTABLE_HPP_
+#define SESAME_INCLUDE_EVALUATION_CONTINGENCYTABLE_HPP_
+#include <Algorithm/DataStructure/Point.hpp>
+#include <cstddef>
+#include <vector>
+namespace SESAME {
+
+/**
+ * Contingency matrix between the predicted clusters (rows) and the ground
+ * truth clusters (columns) of a clustering. A predicted point is matched to
+ * the ground truth point with the same index; each cell sums the weights and
+ * the number of the matched points. The matrix is stored sparsely, row by
+ * row, and rows and columns are numbered in increasing order of their
+ * cluster labels.
+ */
+class ContingencyTable {
+public:
+  struct Cell {
+    int column;
+    double weight;
+    double count;
+  };
+
+  ContingencyTable(const std::vector<PointPtr> &inputs,
+                   const std::vector<PointPtr> &predicts);
+  int rows() const { return (int)rowStart.size() - 1; }
+  int columns() const { return (int)columnCount.size(); }
+
+  // The cells of row r are cells[rowStart[r]] to cells[rowStart[r + 1] - 1]
+  std::vector<size_t> rowStart;
+  std::vector<Cell> cells;
+  std::vector<double> rowCount;    // matched points per predicted cluster
+  std::vector<double> columnCount; // matched points per ground truth cluster
+  double matchedCount = 0;
+  double predictWeight = 0; // weight of all predicted points, matched or not
+};
+} // namespace SESAME
+#endif // SESAME_INCLUDE_EVALUATION_CONTINGENCYTABLE_HPP_
@@ -5,22 +5,22 @@
 #ifndef ONLINEMLBENCHMARK_PURITY_HPP_
 #define ONLINEMLBENCHMARK_PURITY_HPP_
 #include <Algorithm/DataStructure/Point.hpp>
+#include <Evaluation/ContingencyTable.hpp>
 #include <vector>
 namespace SESAME {
 
 class Purity {
-private:
-  static void pointToGroup(const std::vector<SESAME::PointPtr> &input,
-                           std::vector<std::vector<PointPtr>> &group);
-  static double calculateBelongsFromTwo(std::vector<SESAME::PointPtr> &groupA,
-                                        std::vector<SESAME::PointPtr> &groupB);
-  static double getMaxBelongs(std::vector<SESAME::PointPtr> &singleSample,
-                              std::vector<std::vector<PointPtr>> &GT);
-
 public:
-  static double purityCost(const std::vector<PointPtr> &inputs,
-                           const std::vector<PointPtr> &predicts, int dim,
-                           bool decay);
+  /**
+   * Set the weight of every predicted point: 1, or with decay a weight
+   * growing with the point index, so that later points count more
+   */
+  static void setWeights(const std::vector<PointPtr> &predicts, bool decay);
+  /**
+   * @return the weight of the points in the dominant ground truth cluster of
+   * their predicted cluster, over the weight of all predicted points
+   */
+  static double purityCost(const ContingencyTable &table);
 };
 
 } // namespace SESAME
@@ -44,7 +44,8 @@ char const *algo_names[64] = {[BirchType] = "Birch",
                               [G13Stream] = "G13",
                               [G14Stream] = "G14",
                               [G15Stream] = "G15",
-                              [G16Stream] = "G16"};
+                              [G16Stream] = "G16",
+                              [G17Stream] = "G17"};
 
 char const *benne_suffix[4] = {[balance] = "Bal",
                                [accuracy] = "Acc",
@@ -20,6 +20,7 @@
 #include "Algorithm/DesignAspect/V16.hpp"
 #include "Algorithm/DesignAspect/V9.hpp"
 #include "Algorithm/EDMStream.hpp"
+#include "Algorithm/OfflineRefinement/MiniBatchKMeans.hpp"
 #include "Algorithm/OutlierDetection/OutlierDetection.hpp"
 #include "Algorithm/SlidingWindowClustering.hpp"
 #include "Algorithm/StreamKM.hpp"
@@ -139,6 +140,12 @@ AlgorithmPtr AlgorithmFactory::create(param_t &cmd_params) {
   case (G16Stream): {
     return std::make_shared<V16>(cmd_params);
   }
+  case (G17Stream): {
+    return std::make_shared<
+        StreamClustering<Landmark, ClusteringFeaturesList,
+                         DistanceDetection<false, false>, MiniBatchKMeans>>(
+        cmd_params);
+  }
   default:
     throw std::invalid_argument("Unsupported algorithm");
   }
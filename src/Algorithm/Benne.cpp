@@ -50,10 +50,12 @@ void Benne::Init() {
   }
   first_algo = windowSel << 12 | dataSel << 8 | outlierSel << 4 | refineSel;
   change_log.push_back(make_pair(0, first_algo));
+  algo->param.snapshot_interval = 0;
   algo->Init();
 }
 
 void Benne::RunOnline(const PointPtr input) {
+  InstallRefinement(false);
   algo->RunOnline(input);
   if (queue_.size() < T.queue_size) {
     queue_.push_back(input);
@@ -79,17 +81,28 @@ void Benne::RunOnline(const PointPtr input) {
   if (refineSel == Incre &&
       (input->index > 0 && input->index % INCRE_REF_CNT == 0)) {
     ref_timer.Tick();
-    vector<PointPtr> temp_centers, new_centers;
+    InstallRefinement(true);
+    vector<PointPtr> temp_centers;
     algo->OutputOnline(temp_centers);
     if (temp_centers.size())
       cerr << "temp_centers size: " << temp_centers.size() << endl;
-    kmeans.Run(param, temp_centers, new_centers);
     algo->Init();
-    for (auto &center : new_centers) {
-      algo->Insert(center);
+    if (param.benne_background_refine) {
+      // The algorithm goes on from scratch meanwhile, the refined centres are
+      // added to it at the first point after they are ready
+      refinement = std::async(
+          std::launch::async,
+          [this, centers = std::move(temp_centers)]() mutable {
+            return Refine(centers);
+          });
+    } else {
+      for (auto &center : Refine(temp_centers)) {
+        algo->Insert(center);
+      }
     }
     ref_timer.Tock();
   }
+  SnapshotTick();
   lat_timer.Add(input->toa);
 }
 
@@ -111,6 +124,7 @@ void Benne::RunOffline(DataSinkPtr sinkPtr) {
   for (auto &center : materialized_centers)
     sinkPtr->put(center);
   // for (auto &center : centers) sinkPtr->put(center);
+  InstallRefinement(true);
   algo->RunOffline(sinkPtr);
   win_timer.sum += algo->win_timer.sum;
   ds_timer.sum += algo->ds_timer.sum;
@@ -119,6 +133,48 @@ void Benne::RunOffline(DataSinkPtr sinkPtr) {
   sum_timer.Tock();
 }
 
+void Benne::Snapshot() {
+  vector<PointPtr> centers;
+  for (auto &center : materialized_centers)
+    centers.push_back(center->copy());
+  algo->Snapshot();
+  if (auto view = algo->Query()) {
+    centers.insert(centers.end(), view->centers.begin(), view->centers.end());
+  } else {
+    // V16 and V10 publish no views, their online centres are copied instead
+    vector<PointPtr> temp_centers;
+    algo->OutputOnline(temp_centers);
+    for (auto &center : temp_centers)
+      centers.push_back(center->copy());
+  }
+  Publish(std::move(centers));
+}
+
+vector<PointPtr> Benne::Refine(vector<PointPtr> &centers) {
+  vector<PointPtr> new_centers;
+  if (param.benne_mini_batch)
+    miniBatchKMeans.Run(param, centers, new_centers);
+  else
+    kmeans.Run(param, centers, new_centers);
+  return new_centers;
+}
+
+/**
+ * Add the centres of the background refinement to the algorithm, if they are
+ * ready or wait is set. Runs on the ingest thread only, between two points,
+ * so the algorithm never sees a half installed refinement.
+ */
+void Benne::InstallRefinement(bool wait) {
+  if (!refinement.valid())
+    return;
+  if (!wait && refinement.wait_for(std::chrono::seconds(0)) !=
+                   std::future_status::ready)
+    return;
+  for (auto &center : refinement.get()) {
+    algo->Insert(center);
+  }
+}
+
 void Benne::Train(const PointPtr &input) {
   int highDimData = 0;
   int outlierNumber = 0;
@@ -234,6 +290,9 @@ int Benne::Infer(const PointPtr &input) {
 void Benne::UpdateAlgo(int old_algo, int new_algo) {
   if (old_algo == new_algo)
     return;
+  // A pending refinement belongs to the algorithm being replaced, so its
+  // centres migrate along with the others
+  InstallRefinement(true);
   vector<PointPtr> temp_centers;
   algo->OutputOnline(temp_centers);
   win_timer.sum += algo->win_timer.sum;
@@ -302,6 +361,7 @@ void Benne::UpdateAlgo(int old_algo, int new_algo) {
     cerr << "Error: no such algorithm: " << hex << new_algo << dec << endl;
     exit(-1);
   }
+  algo->param.snapshot_interval = 0;
   algo->Init();
   if (obj == efficiency || obj == accuracy_no_migration) {
     for (auto &center : temp_centers) {
@@ -28,6 +28,7 @@ SESAME::CluStream::CluStream(param_t &cmd_params) {
   this->CluStreamParam.radius = cmd_params.radius;
   this->CluStreamParam.seed = cmd_params.seed;
   this->CluStreamParam.buf_size = cmd_params.buf_size;
+  this->kmeans = std::make_shared<KMeans>(cmd_params);
   if (this->CluStreamParam.offline_time_window >
       this->CluStreamParam.num_points)
     this->CluStreamParam.offline_time_window = cmd_params.offline_time_window;
@@ -61,6 +62,11 @@ void SESAME::CluStream::initOffline(vector<PointPtr> &initData,
     else
       microClusters[clusterId]->insert(initialData[i], timestamp);
   }
+  nearestCluster.assign(CluStreamParam.num_clusters, -1);
+  nearestDistance.assign(CluStreamParam.num_clusters, doubleMax);
+  changed.assign(CluStreamParam.num_clusters, false);
+  for (int i = 0; i < CluStreamParam.num_clusters; i++)
+    markChanged(i);
 }
 
 /**
@@ -76,18 +82,19 @@ void SESAME::CluStream::initOffline(vector<PointPtr> &initData,
  */
 void SESAME::CluStream::incrementalCluster(
     PointPtr data) { // 1. Determine closest clusters
-  MicroClusterPtr closestCluster;
+  int closestIndex = 0;
   double minDistance = doubleMax;
   for (int i = 0; i < this->CluStreamParam.num_clusters; i++) {
     double dist = microClusters[i]->calCentroidDistance(data);
     if (dist < minDistance) {
-      closestCluster = microClusters[i]->copy();
+      closestIndex = i;
       minDistance = dist;
     }
   }
-  double radius = calRadius(closestCluster);
+  double radius = calRadius(closestIndex);
   if (minDistance < radius) {
-    insertIntoCluster(data, closestCluster);
+    insertIntoCluster(data, microClusters[closestIndex]);
+    markChanged(closestIndex);
     return;
   }
   /** 3. Date does not fit  -- free
@@ -101,23 +108,19 @@ void SESAME::CluStream::incrementalCluster(
 }
 
 // Calculate and return the value of radius
-double SESAME::CluStream::calRadius(MicroClusterPtr closestCluster) {
+double SESAME::CluStream::calRadius(int closestIndex) {
   double radius;
-  if (closestCluster->weight == 1) {
+  if (microClusters[closestIndex]->weight == 1) {
     // Special case: estimate radius by determining the distance to the
     // next closest cluster
     radius = doubleMax;
-    dataPoint centroid = closestCluster->getCentroid();
-    for (int i = 0; i < this->CluStreamParam.num_clusters; i++) {
-      if (microClusters[i]->id == closestCluster->id) {
-        continue;
-      }
-      double dist = distance(microClusters[i]->getCentroid(), centroid,
-                             this->CluStreamParam.dim);
-      radius = std::min(dist, radius);
+    if (this->CluStreamParam.num_clusters > 1) {
+      repairNearest();
+      radius = sqrt(nearestDistance[closestIndex]);
     }
   } else
-    radius = closestCluster->getRadius(this->CluStreamParam.radius);
+    radius =
+        microClusters[closestIndex]->getRadius(this->CluStreamParam.radius);
   return radius;
 }
 
@@ -150,6 +153,7 @@ bool SESAME::CluStream::deleteCreateCluster(PointPtr data) {
       microClusters[i] =
           DataStructureFactory::createMicroCluster(CluStreamParam.dim, newId);
       microClusters[i]->Init(std::move(data), elapsedTime);
+      markChanged(i);
       pointsForgot++;
 
       return true;
@@ -163,21 +167,18 @@ bool SESAME::CluStream::deleteCreateCluster(PointPtr data) {
 
 void SESAME::CluStream::MergeCreateCluster(PointPtr data) {
   // SESAME_INFO("Micro cluster needs to merge");
-  unsigned int closestA = 0;
-  unsigned int closestB = 0;
-  double minDistance = doubleMax;
-  for (int i = 0; i < this->CluStreamParam.num_clusters; i++) { // O(n(n+1)/2)
-    dataPoint centroidA = microClusters[i]->getCentroid();
-    for (int j = i + 1; j < this->CluStreamParam.num_clusters; j++) {
-      double dist = distance(centroidA, microClusters[j]->getCentroid(),
-                             this->CluStreamParam.dim);
-      if (dist < minDistance) {
-        minDistance = dist;
-        closestA = i;
-        closestB = j;
-      }
-    }
+  // The closest pair is the micro cluster with the nearest neighbour
+  repairNearest();
+  int closest = 0;
+  for (int i = 1; i < this->CluStreamParam.num_clusters; i++) {
+    if (nearestDistance[i] < nearestDistance[closest])
+      closest = i;
   }
+  // A single micro cluster has no neighbour and absorbs itself
+  int neighbour =
+      nearestCluster[closest] < 0 ? closest : nearestCluster[closest];
+  int closestA = std::min(closest, neighbour);
+  int closestB = std::max(closest, neighbour);
   int newId = this->CluStreamParam.num_clusters + pointsForgot + pointsMerged;
   microClusters[closestA]->merge(microClusters[closestB]);
   int elapsedTime = data->getIndex();
@@ -185,6 +186,8 @@ void SESAME::CluStream::MergeCreateCluster(PointPtr data) {
   microClusters[closestB] =
       DataStructureFactory::createMicroCluster(CluStreamParam.dim, newId);
   microClusters[closestB]->Init(std::move(data), elapsedTime);
+  markChanged(closestA);
+  markChanged(closestB);
   pointsMerged++;
   return;
 }
@@ -203,13 +206,69 @@ void SESAME::CluStream::microClusterToPoint(
     points.push_back(point);
   }
 }
-double SESAME::CluStream::distance(dataPoint a, dataPoint b, int dim) {
+double SESAME::CluStream::squaredDistance(int indexA, int indexB) const {
+  const dataPoint &a = microClusters[indexA]->centroid;
+  const dataPoint &b = microClusters[indexB]->centroid;
   double temp = 0;
-  for (int i = 0; i < dim; i++) {
+  for (int i = 0; i < this->CluStreamParam.dim; i++) {
     double diff = b[i] - a[i];
     temp += diff * diff;
   }
-  return sqrt(temp);
+  return temp;
+}
+
+// Record that the centroid of a micro cluster moved or was replaced
+void SESAME::CluStream::markChanged(int index) {
+  if (!changed[index]) {
+    changed[index] = true;
+    changedClusters.push_back(index);
+  }
+}
+
+/**
+ * @Description: bring the nearest neighbours of all micro clusters up to date.
+ * Each changed micro cluster finds its nearest neighbour with one scan, which
+ * also lowers the entries of unchanged micro clusters it came closer to. An
+ * unchanged micro cluster whose nearest neighbour moved away scans again.
+ * O(changed * q * dim) instead of the O(q^2 * dim) all-pairs scan.
+ */
+void SESAME::CluStream::repairNearest() {
+  int size = this->CluStreamParam.num_clusters;
+  std::vector<int> rescan;
+  for (int index : changedClusters) {
+    nearestCluster[index] = -1;
+    nearestDistance[index] = doubleMax;
+    for (int i = 0; i < size; i++) {
+      if (i == index)
+        continue;
+      double dist = squaredDistance(index, i);
+      if (dist < nearestDistance[index]) {
+        nearestDistance[index] = dist;
+        nearestCluster[index] = i;
+      }
+      if (changed[i])
+        continue;
+      if (nearestCluster[i] == index) {
+        if (dist <= nearestDistance[i])
+          nearestDistance[i] = dist;
+        else
+          rescan.push_back(i);
+      } else if (dist < nearestDistance[i]) {
+        nearestDistance[i] = dist;
+        nearestCluster[i] = index;
+      }
+    }
+  }
+  for (int index : changedClusters)
+    changed[index] = false;
+  changedClusters.clear();
+  for (int index : rescan) {
+    if (changed[index])
+      continue; // already rescanned
+    markChanged(index);
+  }
+  if (!changedClusters.empty())
+    repairNearest();
 }
 
 void SESAME::CluStream::Init() {
@@ -288,22 +347,23 @@ void SESAME::CluStream::RunOffline(SESAME::DataSinkPtr sinkPtr) {
     landmarkSnapshot = SESAME::Snapshot::findSnapshot(
         window->orderSnapShots, landmarkTime, elapsedTime,
         window->pyramidalWindow.currentOrder);
+    // Without a stored landmark the current micro clusters are used as they
+    // are, i.e. the whole stream is observed
+    if (landmarkSnapshot && landmarkSnapshot->elapsedTime != -1) {
+      // SESAME_INFO("Landmark Miro Cluster is...");
+      for (int i = 0; i < CluStreamParam.num_clusters; i++) {
+        std::stringstream re2;
+        std::copy(landmarkSnapshot->microClusters[i]->id.begin(),
+                  landmarkSnapshot->microClusters[i]->id.end(),
+                  std::ostream_iterator<int>(re2, " "));
+        // SESAME_INFO("The ID is " << re2.str() << "weight is " <<
+        // landmarkSnapshot->microClusters[i]->weight);
+      }
 
-    // SESAME_INFO("Landmark Miro Cluster is...");
-    for (int i = 0; i < CluStreamParam.num_clusters; i++) {
-      std::stringstream re2;
-      std::copy(landmarkSnapshot->microClusters[i]->id.begin(),
-                landmarkSnapshot->microClusters[i]->id.end(),
-                std::ostream_iterator<int>(re2, " "));
-      // SESAME_INFO("The ID is " << re2.str() << "weight is " <<
-      // landmarkSnapshot->microClusters[i]->weight);
+      subtractMiroCluster = SESAME::Snapshot::substractSnapshot(
+          subtractMiroCluster, landmarkSnapshot,
+          this->CluStreamParam.num_clusters);
     }
-    if (landmarkSnapshot->elapsedTime == -1)
-      landmarkSnapshot = subtractMiroCluster;
-
-    subtractMiroCluster = SESAME::Snapshot::substractSnapshot(
-        subtractMiroCluster, landmarkSnapshot,
-        this->CluStreamParam.num_clusters);
   }
   // SESAME_INFO("subtract Miro Cluster is...");
   for (int i = 0; i < CluStreamParam.num_clusters; i++) {
@@ -4,15 +4,21 @@
 #include <Algorithm/DBStream.hpp>
 #include <Algorithm/WindowModel/WindowFactory.hpp>
 
+#include <climits>
+#include <stdexcept>
+
 /**
  * @Description: initialize user defined parameters,
  * @Param:
  * radius: radius of micro clusters
  * lambda: lambda in decay function
- * clean_interval: time gap of clean up
+ * clean_interval: steps for a weight of 1 to decay to the weak threshold
+ * W_weak of micro clusters (alpha * W_weak for shared density entries)
  * min_weight: the minimum weight of micro cluster to identify noise MCs
  * alpha: intersection factor
  * base: decay function base -- Normally 2
+ * rebuild_interval: points between rebuilds of the online connected regions,
+ * 0 finds the regions offline only
  * @Return: void
  */
 SESAME::DBStream::DBStream(param_t &cmd_params) {
@@ -25,6 +31,12 @@ SESAME::DBStream::DBStream(param_t &cmd_params) {
   this->dbStreamParams.min_weight = cmd_params.min_weight;
   this->dbStreamParams.alpha = cmd_params.alpha;
   this->dbStreamParams.base = cmd_params.base;
+  this->dbStreamParams.rebuild_interval = (int)cmd_params.rebuild_interval;
+  // Without online regions every snapshot would recluster all micro clusters
+  // on the ingest thread
+  if (cmd_params.snapshot_interval > 0 && cmd_params.rebuild_interval == 0)
+    throw std::invalid_argument(
+        "DBStream snapshots require rebuild_interval > 0");
 }
 SESAME::DBStream::~DBStream() = default;
 
@@ -46,6 +58,7 @@ void SESAME::DBStream::Init() {
   // std::cout<<"weakEntry"<<weakEntry<<std::endl;
   // std::cout<<"aWeakEntry"<<aWeakEntry<<std::endl;
   this->microClusterIndex = -1;
+  this->pointsSinceRebuild = 0;
   connectedRegions =
       ConnectedRegions(dbStreamParams.alpha, dbStreamParams.min_weight);
   sum_timer.Tick();
@@ -67,6 +80,7 @@ void SESAME::DBStream::RunOnline(PointPtr input) {
     lastArrivingTime = pointArrivingTime;
     lastArrivingTime0 = pointArrivingTime0;
   }
+  SnapshotTick();
   lat_timer.Add(input->toa);
 }
 
@@ -78,18 +92,40 @@ void SESAME::DBStream::RunOffline(DataSinkPtr sinkPtr) {
   //  std::cout<<"micro clusters "<<microClusters.size()<<std::endl;
   //  std::cout<<"weightedAdjacencyList
   //  "<<weightedAdjacencyList.size()<<std::endl;
-  connectedRegions.connection(microClusters, weightedAdjacencyList);
-  std::vector<PointPtr> points = connectedRegions.ResultsToDataSink();
-  for (auto i = 0; i < points.size(); i++) {
-    auto res = points[i];
-    res->setClusteringCenter(i);
+  for (auto &res : macroClusters())
     sinkPtr->put(res);
-  }
 
   // timerMeter.printTime(false,false,true,false);
   ref_timer.Tock();
   sum_timer.Tock();
 }
+/**
+ * @Description: publish the current macro clusters for Query(); snapshots
+ * require online regions, so this only reads off the components
+ * @Param: void
+ * @Return: void
+ */
+void SESAME::DBStream::Snapshot() { Publish(macroClusters()); }
+
+/**
+ * @Description: find the macro clusters of the current micro clusters, each
+ * as a pseudo point labelled with its index
+ * @Param: void
+ * @Return: the macro clusters
+ */
+std::vector<SESAME::PointPtr> SESAME::DBStream::macroClusters() {
+  // The online regions are up to date but for the edges that weakened since
+  // the last rebuild, so only the components have to be read off
+  if (onlineRegions())
+    connectedRegions.findConnectedComponents();
+  else
+    connectedRegions.connection(microClusters, weightedAdjacencyList);
+  std::vector<PointPtr> points = connectedRegions.ResultsToDataSink();
+  for (auto i = 0; i < points.size(); i++)
+    points[i]->setClusteringCenter(i);
+  return points;
+}
+
 /**
  * @Description: Insert data point into existing MCs,
  * first find the MCs which data point locates in, if finding no MCs,
@@ -125,7 +161,13 @@ void SESAME::DBStream::update(PointPtr dataPoint) {
         SESAME::DataStructureFactory::createMicroCluster(
             dbStreamParams.dim, microClusterIndex, dataPoint,
             dbStreamParams.radius);
+    slotOfId[microClusterIndex] = microClusters.size();
     microClusters.push_back(newMicroCluster);
+    if (onlineRegions())
+      connectedRegions.addVertex(newMicroCluster);
+    expiryQueue.push({expiryTime(pointArrivingTime, newMicroCluster->weight,
+                                 weakEntry),
+                      false, (WeightedAdjacencyList::Key)microClusterIndex});
     microClusterNN.push_back(newMicroCluster);
     ds_timer.Tock();
   } else {
@@ -137,33 +179,33 @@ void SESAME::DBStream::update(PointPtr dataPoint) {
       // std::cout<<" cluster "<<microClusterNN[i]->id.front()<<"th weight is
       // "<<microClusterNN[i]->weight<<std::endl;
       for (int j = i + 1; j < sizeNN; j++) {
-        ds_timer.Tick();
-        MicroClusterPair microClusterPair(microClusterNN[i],
-                                          microClusterNN.at(j));
-        ds_timer.Tock();
         win_timer.Tick();
-        if (weightedAdjacencyList.find(microClusterPair) !=
-            weightedAdjacencyList.end()) {
+        int id1 = microClusterNN[i]->id.front();
+        int id2 = microClusterNN[j]->id.front();
+        AdjustedWeight *adjustedWeight = weightedAdjacencyList.find(id1, id2);
+        if (adjustedWeight != nullptr) {
           // SESAME_INFO("update Sij");
           // update existing micro cluster pair in the graph
-          int startT = weightedAdjacencyList[microClusterPair]->updateTime;
+          int startT = adjustedWeight->updateTime;
           double decayValue =
               dampedWindow->decayFunction(startT, this->pointArrivingTime);
           // Timespec
-          // timespec startT=
-          // weightedAdjacencyList[microClusterPair]->updateTime0; double
+          // timespec startT= adjustedWeight->updateTime0; double
           // decayValue0 =
           // dampedWindow->decayFunction(startT,this->pointArrivingTime0);
-          weightedAdjacencyList[microClusterPair]->add(this->pointArrivingTime,
-                                                       decayValue);
+          adjustedWeight->add(this->pointArrivingTime, decayValue);
         } else {
           // SESAME_INFO("insert Sij");
-          AdjustedWeightPtr adjustedWeight =
-              SESAME::DataStructureFactory::createAdjustedWeight(
-                  1, this->pointArrivingTime, this->pointArrivingTime0);
-          DensityGraph densityGraph(microClusterPair, adjustedWeight);
-          weightedAdjacencyList.insert(densityGraph);
+          adjustedWeight = &weightedAdjacencyList.insert(
+              id1, id2,
+              AdjustedWeight(1, this->pointArrivingTime,
+                             this->pointArrivingTime0));
+          expiryQueue.push({expiryTime(pointArrivingTime, 1, aWeakEntry), true,
+                            WeightedAdjacencyList::pairKey(id1, id2)});
         }
+        // Edges only grow here; weakened ones are undone by the next rebuild
+        if (onlineRegions())
+          connectedRegions.link(id1, id2, adjustedWeight->weight);
         win_timer.Tock();
       }
     }
@@ -175,15 +217,13 @@ void SESAME::DBStream::update(PointPtr dataPoint) {
   }
   out_timer.Tick();
 
-  // if (((pointArrivingTime-this->lastCleanTime)/CLOCKS_PER_SEC)>=
-  // dbStreamParams.clean_interval
-  // && dataPoint->getIndex()!=0)
-  if ((pointArrivingTime) % dbStreamParams.clean_interval == 0)
-  // if(interval/1000L%dbStreamParams.clean_interval==0 )
-  {
-    cleanUp(pointArrivingTime); // pointArrivingTime
-
-    this->lastCleanTime = this->pointArrivingTime;
+  // Drop the entries that became weak by now, a bounded slice per point
+  cleanUp(pointArrivingTime);
+  this->lastCleanTime = this->pointArrivingTime;
+  if (onlineRegions() &&
+      ++pointsSinceRebuild >= dbStreamParams.rebuild_interval) {
+    connectedRegions.rebuild(microClusters, weightedAdjacencyList);
+    pointsSinceRebuild = 0;
   }
   out_timer.Tock();
 }
@@ -219,44 +259,84 @@ bool SESAME::DBStream::checkMove(
   return true;
 }
 
+/**
+ * @Description: projected time at which a weight decaying from now on falls to
+ * the threshold,
+ * @Param: current time, current weight and threshold
+ * @Return: the projected time, at least one step after now
+ */
+int SESAME::DBStream::expiryTime(int nowTime, double weight,
+                                 double threshold) const {
+  double steps = std::log(weight / threshold) /
+                 (dbStreamParams.lambda * std::log(dbStreamParams.base));
+  if (!(steps < INT_MAX - nowTime)) // also catches lambda = 0 or base = 1
+    return INT_MAX;
+  return std::max(nowTime + 1, nowTime + (int)std::ceil(steps));
+}
+
+/**
+ * @Description: handle the expiry events that are due, at most CLEAN_SLICE
+ * per call: micro clusters weaker than W_weak and shared density entries
+ * weaker than alpha * W_weak are removed, the others are rescheduled. This
+ * replaces the full scan every clean_interval points.
+ * @Param: current time
+ * @Return: void
+ */
 void SESAME::DBStream::cleanUp(int nowTime) {
-  std::vector<MicroClusterPtr> removeMicroCluster;
-  std::vector<MicroClusterPtr>::size_type iter;
-  // Check the current micro Clusters whether they have weak MCs
-  // This just test for remove id
-  std::vector<int> idList;
-  for (iter = 0; iter < microClusters.size(); iter++) {
-    if (microClusters.at(iter)->weight <= this->weakEntry) {
-      removeMicroCluster.push_back(microClusters.at(iter)->copy());
-      idList.push_back(microClusters.at(iter)->id.front());
-      microClusters.erase(microClusters.begin() +
-                          int(iter)); // Delete this MC from current MC list
-    }
-  }
-  auto iterW = weightedAdjacencyList.begin();
-  while (iterW != weightedAdjacencyList.end()) {
-    auto val1 = iterW->first.microCluster1->id.front(),
-         val2 = iterW->first.microCluster2->id.front();
-    auto exist1 = std::find_if(
-        removeMicroCluster.begin(), removeMicroCluster.end(),
-        [&](const MicroClusterPtr &mc) { return mc->id.front() == val1; });
-    auto exist2 = std::find_if(
-        removeMicroCluster.begin(), removeMicroCluster.end(),
-        [&](const MicroClusterPtr &mc) { return mc->id.front() == val2; });
-    if (exist1 != removeMicroCluster.end() ||
-        exist2 != removeMicroCluster.end()) {
-      iterW = weightedAdjacencyList.erase(iterW);
+  for (int handled = 0; handled < CLEAN_SLICE && !expiryQueue.empty() &&
+                        expiryQueue.top().dueTime <= nowTime;
+       handled++) {
+    ExpiryEvent event = expiryQueue.top();
+    expiryQueue.pop();
+    double weight;
+    if (event.edge) {
+      int id1 = WeightedAdjacencyList::firstId(event.key);
+      int id2 = WeightedAdjacencyList::secondId(event.key);
+      AdjustedWeight *adjustedWeight = weightedAdjacencyList.find(id1, id2);
+      if (adjustedWeight == nullptr)
+        continue;
+      // The entries of a removed micro cluster are dropped here, lazily
+      if (!slotOfId.count(id1) || !slotOfId.count(id2)) {
+        weightedAdjacencyList.erase(id1, id2);
+        continue;
+      }
+      weight = adjustedWeight->getCurrentWeight(
+          dampedWindow->decayFunction(adjustedWeight->updateTime, nowTime));
+      if (weight < aWeakEntry) {
+        weightedAdjacencyList.erase(id1, id2);
+        continue;
+      }
+      event.dueTime = expiryTime(nowTime, weight, aWeakEntry);
     } else {
-      double decayFactor =
-          dampedWindow->decayFunction(iterW->second->updateTime, nowTime);
-      // double
-      // decayFactor0=dampedWindow->decayFunction(iterW->second->updateTime0,nowTime);
-      if (iterW->second->getCurrentWeight(decayFactor) < aWeakEntry)
-        iterW = weightedAdjacencyList.erase(iterW);
-      else
-        iterW++;
+      auto slot = slotOfId.find((int)event.key);
+      if (slot == slotOfId.end())
+        continue;
+      weight = microClusters[slot->second]->weight;
+      if (weight <= this->weakEntry) {
+        removeMicroCluster(slot->second);
+        continue;
+      }
+      event.dueTime = expiryTime(nowTime, weight, weakEntry);
     }
+    expiryQueue.push(event);
+  }
+}
+
+/**
+ * @Description: remove the micro cluster at slot, moving the last micro
+ * cluster into the freed slot. Its shared density entries are dropped when
+ * their expiry events come due
+ * @Param: index of the micro cluster in microClusters
+ * @Return: void
+ */
+void SESAME::DBStream::removeMicroCluster(size_t slot) {
+  int id = microClusters[slot]->id.front();
+  if (onlineRegions())
+    connectedRegions.removeVertex(id);
+  slotOfId.erase(id);
+  if (slot + 1 != microClusters.size()) {
+    microClusters[slot] = std::move(microClusters.back());
+    slotOfId[microClusters[slot]->id.front()] = slot;
   }
-  //  SESAME_INFO("CLEAN! now weightedAdjacencyList
-  //  size:"<<weightedAdjacencyList.size());
+  microClusters.pop_back();
 }
@@ -7,6 +7,7 @@
 #include "Algorithm/WindowModel/WindowFactory.hpp"
 
 #include <cfloat>
+#include <climits>
 #include <cmath>
 #include <iostream>
 
@@ -50,6 +51,7 @@ void SESAME::DStream::RunOnline(PointPtr input) {
     //    SESAME_INFO("Cluster number is "<<clusterList.size());
   }
   ds_timer.Tock();
+  SnapshotTick();
 
   lat_timer.Add(input->toa);
 }
@@ -60,6 +62,19 @@ void SESAME::DStream::RunOffline(DataSinkPtr sinkPtr) {
   on_timer.Add(sum_timer.start);
   ref_timer.Tick();
   // SESAME_INFO(" cluster list size "<<clusterList.size());
+  for (auto &point : gridClusterCenters())
+    sinkPtr->put(point);
+  ref_timer.Tock();
+  sum_timer.Tock();
+}
+
+void SESAME::DStream::Snapshot() { Publish(gridClusterCenters()); }
+
+/**
+ * Pseudo point of every grid cluster, labelled with its index
+ */
+std::vector<SESAME::PointPtr> SESAME::DStream::gridClusterCenters() {
+  std::vector<PointPtr> centers;
   int cluID = 0;
   for (auto iter = 0; iter != this->clusterList.size(); iter++) {
     PointPtr point = GenericFactory::New<Point>(param.dim, iter);
@@ -81,10 +96,9 @@ void SESAME::DStream::RunOffline(DataSinkPtr sinkPtr) {
       count++;
     }
     point->setClusteringCenter(cluID++);
-    sinkPtr->put(point);
+    centers.push_back(point);
   }
-  ref_timer.Tock();
-  sum_timer.Tock();
+  return centers;
 }
 
 void SESAME::DStream::ifReCalculate(PointPtr point) {
@@ -119,6 +133,9 @@ void SESAME::DStream::reCalculateParameter() {
     this->dl = dlBack;
     this->dm = dmBack;
     this->NGrids = curGridNumber;
+    // The thresholds moved, so every scheduled evaluation is invalid
+    densityRescan = true;
+    sporadicRescan = true;
     // // SESAME_INFO(" dl = " << this->dl << ", dm = " << this->dm);
     // // SESAME_INFO("TOTAL GRIDS ARE "<<this->NGrids);
     // Calculate the value for gap using the method defined in eq 26 of Chen and
@@ -157,7 +174,11 @@ void SESAME::DStream::GridListUpdate(std::vector<int> coordinate) {
       characteristicVec =
           CharacteristicVector(currentTimeStamp, -1, 1.0, -1, false, dl, dm);
     // this->gridList.insert(std::make_pair(grid, characteristicVec));
-    this->gridList.insert(std::make_pair(grid, characteristicVec));
+    it = this->gridList.insert(std::make_pair(grid, characteristicVec)).first;
+    scheduleGrid(densityQueue, &CharacteristicVector::densityDueTime, grid,
+                 it->second, currentTimeStamp);
+    scheduleGrid(sporadicQueue, &CharacteristicVector::sporadicDueTime, grid,
+                 it->second, currentTimeStamp);
   }
   // 4. Update the characteristic vector of dg
   else {
@@ -168,6 +189,13 @@ void SESAME::DStream::GridListUpdate(std::vector<int> coordinate) {
     characteristicVec.densityWithNew(currentTimeStamp, param.lambda);
     characteristicVec.updateTime = currentTimeStamp;
     it->second = characteristicVec;
+    // The grid has to be re-evaluated at the next gap
+    if (it->second.densityDueTime > currentTimeStamp)
+      scheduleGrid(densityQueue, &CharacteristicVector::densityDueTime, grid,
+                   it->second, currentTimeStamp);
+    if (it->second.sporadicDueTime > currentTimeStamp)
+      scheduleGrid(sporadicQueue, &CharacteristicVector::sporadicDueTime, grid,
+                   it->second, currentTimeStamp);
     win_timer.Tock();
     ds_timer.Tick();
   }
@@ -183,129 +211,103 @@ void SESAME::DStream::initialClustering() {
   // 2. Assign each dense grid to a distinct cluster
   // and
   // 3. Label all other grids as NO_CLASS
-  auto gridIter = this->gridList.begin();
-  HashMap newGridList;
-  while (gridIter != gridList.end()) {
-    DensityGrid grid = gridIter->first;
-    CharacteristicVector characteristicVecOfG = gridIter->second;
-    if (characteristicVecOfG.attribute == DENSE) {
-      int gridClass = this->clusterList.size();
-      characteristicVecOfG.label = gridClass;
-      GridCluster gridCluster = GridCluster(gridClass);
-      gridCluster.addGrid(grid);
-      this->clusterList.push_back(gridCluster);
-      // SESAME_INFO(" was dense (class "<<gridClass<<")" <<"Position is
-      // "<<this->clusterList.size());
-    } else
-      characteristicVecOfG.label = NO_CLASS;
-    // newGridList.insert(std::make_pair(grid, characteristicVecOfG));
-    // newGridList= putHashMap(newGridList,grid, characteristicVecOfG);
-
-    auto it1 = newGridList.find(grid);
-    if (it1 != newGridList.end())
-      it1->second = characteristicVecOfG;
-    else
-      newGridList.insert(std::make_pair(grid, characteristicVecOfG));
+  // and
+  // 4. Make changes to grid labels until no more changes can be made, i.e.
+  //    merge clusters of neighbouring grids and absorb neighbouring
+  //    transitional grids. This converges to the connected components of the
+  //    dense and transitional grids, which are found in one parallel pass.
+  this->clusterList = GridCluster::connectedClusters(this->gridList);
+}
 
-    ++gridIter;
+/**
+ * Updates the density of the density grids whose attribute may have changed
+ * since the last call, i.e. grids that received points and grids whose decay
+ * crosses dl or dm by now. All other grids keep their attribute, so they are
+ * left untouched. The whole grid_list is only refreshed after dl and dm moved.
+ */
+void SESAME::DStream::updateGridListDensity() {
+  // // SESAME_INFO("grid list size is "<<this->gridList.size());
+  // Changes of the last call have been handled by now
+  for (auto &grid : changedGrids) {
+    auto iter = gridList.find(grid);
+    if (iter != gridList.end()) {
+      iter->second.attChange = false;
+      iter->second.isVisited = false;
+    }
+  }
+  changedGrids.clear();
+  if (densityRescan) {
+    densityQueue = GridEventQueue();
+    for (auto &iter : this->gridList)
+      refreshGridDensity(iter.first, iter.second);
+    densityRescan = false;
+  } else {
+    for (auto &grid :
+         popDueGrids(densityQueue, &CharacteristicVector::densityDueTime))
+      refreshGridDensity(grid, gridList.find(grid)->second);
   }
-  this->gridList = newGridList;
-  // 4. Make changes to grid labels by doing:
-  //    a. For each cluster c
-  //    b. For each outside grid g of c
-  //    c. For each neighbouring grid h of g
-  //    d. If h belongs to c', label c and c' with
-  //       the label of the largest cluster
-  //    e. Else if h is transitional, assign it to c
-  //    f. While changes can be made
-  while (adjustLabels())
-    ; // while changes are being made
 }
+
 /**
- * Makes first change available to it by following the steps:
- * For each cluster c<
- * For each outside grid g of c
- * For each neighbouring grid h of g
- * If h belongs to c', label c and c' with the label of the largest cluster
- * Else if h is transitional, assign it to c
- * @return TRUE if a change was made to any cluster's labels, FALSE otherwise
+ * Brings the attribute of a grid up to date, records it in changedGrids if it
+ * changed and schedules the time at which decay will change it next.
  */
-bool SESAME::DStream::adjustLabels() {
-  // bool adjust=false;
-  // a. For each cluster c
-
-  for (GridCluster &gridCluster : this->clusterList) {
-    // // SESAME_INFO("Adjusting from cluster "<<gridCluster.clusterLabel<<",
-    // standby..."); b. for each grid, dg, of c
-    for (auto gridIter = gridCluster.grids.begin();
-         gridIter != gridCluster.grids.end(); gridIter++) {
-      const DensityGrid &grid = gridIter->first;
-      bool inside = gridIter->second;
-      // // SESAME_INFO(" Inspecting density grid, grid, standby...");
-
-      // b. for each OUTSIDE grid of cluster
-      if (!inside) {
-        //  // SESAME_INFO(" Density grid dg is outside!");
-        // c. for each neighbouring grid, of current iter grid
-        for (const DensityGrid &gridNeighbourhood : grid.getNeighbours()) {
-          auto it2 = this->gridList.find(gridNeighbourhood);
-          if (it2 != gridList.end()) {
-            auto it1 = this->gridList.find(grid);
-            CharacteristicVector characteristicVec1 = it1->second;
-            CharacteristicVector characteristicVec2 = it2->second;
-            int class1 = characteristicVec1.label;
-            int class2 = characteristicVec2.label;
-            // ...and if neighbouring grid isn't already in the same cluster as
-            // grid...
-            if (class1 != class2) {
-              // If neighbouring grid is in cluster c', merge c and c' into the
-              // larger of the two
-              if (class2 != NO_CLASS) {
-                // SESAME_INFO(". Cluster number is "<<clusterList.size()<<
-                // "Neighbour 1 and 2 are "<<class1<<" "<<class2);
-                if (this->clusterList.at(class1).grids.size() <
-                    this->clusterList.at(class2).grids.size())
-                  mergeClusters(class1, class2);
-                else
-                  mergeClusters(class2, class1);
-                return true;
-              }
-              // If gridNeighbourhood is transitional and 'outside' of the
-              // cluster, assign it to cluster
-              else if (characteristicVec2.isTransitional(dm, dl)) {
-                ////TODO CHECK HERE
-                characteristicVec2.label = class1;
-                gridCluster.addGrid(gridNeighbourhood);
-                this->clusterList.at(class1) = gridCluster; // Testing
-                // putHashMap(gridList,grid,characteristicVec2);
-                auto it1 = gridList.find(grid);
-                if (it1 != gridList.end())
-                  it1->second = characteristicVec2;
-                else
-                  gridList.insert(std::make_pair(grid, characteristicVec2));
+void SESAME::DStream::refreshGridDensity(
+    const DensityGrid &grid, CharacteristicVector &characteristicVec) {
+  // A grid may be refreshed twice in one call, keep the first change
+  bool changed = characteristicVec.attChange;
+  characteristicVec.UpdateAllDensity(currentTimeStamp, param.lambda, dl, dm);
+  if (characteristicVec.attChange && !changed)
+    changedGrids.push_back(grid);
+  characteristicVec.attChange = characteristicVec.attChange || changed;
+  scheduleGrid(
+      densityQueue, &CharacteristicVector::densityDueTime, grid,
+      characteristicVec,
+      max(characteristicVec.nextAttributeChange(param.lambda, dl, dm),
+          currentTimeStamp + 1));
+}
 
-                return true;
-              }
-            }
-          }
-        }
-      }
-    }
+/**
+ * Records the time at which a grid is due and queues it. Stale entries are
+ * dropped by rebuilding the queue once they outnumber the live grids.
+ */
+void SESAME::DStream::scheduleGrid(GridEventQueue &queue,
+                                   int CharacteristicVector::*dueTime,
+                                   const DensityGrid &grid,
+                                   CharacteristicVector &characteristicVec,
+                                   int time) {
+  characteristicVec.*dueTime = time;
+  if (queue.size() < 4 * gridList.size() + 1024) {
+    queue.push({time, grid});
+    return;
   }
-  return false;
+  GridEventQueue compacted;
+  for (auto &iter : gridList) {
+    if (iter.second.*dueTime >= 0)
+      compacted.push({iter.second.*dueTime, iter.first});
+  }
+  queue.swap(compacted);
 }
 
 /**
- * Iterates through grid_list and updates the density for each density grid
- * therein. Also marks each density grid as unvisited for this call to
- * adjustClustering.
+ * Pops the grids which are due by the current time stamp, skipping stale
+ * entries and duplicates. The due time of a popped grid is reset to -1 until
+ * the caller schedules it again.
  */
-void SESAME::DStream::updateGridListDensity() {
-  // // SESAME_INFO("grid list size is "<<this->gridList.size());
-  for (auto &iter : this->gridList) {
-    iter.second.isVisited = false;
-    iter.second.UpdateAllDensity(currentTimeStamp, param.lambda, dl, dm);
+std::vector<SESAME::DensityGrid>
+SESAME::DStream::popDueGrids(GridEventQueue &queue,
+                             int CharacteristicVector::*dueTime) {
+  std::vector<DensityGrid> dueGrids;
+  while (!queue.empty() && queue.top().dueTime <= currentTimeStamp) {
+    auto iter = gridList.find(queue.top().grid);
+    if (iter != gridList.end() &&
+        iter->second.*dueTime == queue.top().dueTime) {
+      iter->second.*dueTime = -1;
+      dueGrids.push_back(queue.top().grid);
+    }
+    queue.pop();
   }
+  return dueGrids;
 }
 
 /**
@@ -321,6 +323,12 @@ void SESAME::DStream::adjustClustering() {
   //    a. If dg is sparse
   //    b. If dg is dense
   //    c. If dg is transitional
+  // Relabelling all grids in parallel is cheaper than adjusting many changed
+  // grids one after another
+  if (changedGrids.size() > GridCluster::RELABEL_RATIO * gridList.size()) {
+    this->clusterList = GridCluster::connectedClusters(this->gridList);
+    return;
+  }
   while (inspectChangedGrids())
     ;
 }
@@ -334,11 +342,15 @@ void SESAME::DStream::adjustClustering() {
  */
 bool SESAME::DStream::inspectChangedGrids() {
   HashMap newGridList;
-  auto gridIter = this->gridList.begin();
+  auto changedIter = this->changedGrids.begin();
   int a = 0;
-  while (gridIter != gridList.end() &&
+  while (changedIter != changedGrids.end() &&
          newGridList.empty()) //&& newGridList.empty()
   {
+    auto gridIter = gridList.find(*changedIter);
+    changedIter++;
+    if (gridIter == gridList.end())
+      continue;
     const DensityGrid &grid = gridIter->first;
     const CharacteristicVector &characteristicVec = gridIter->second;
     int gridClass = characteristicVec.label;
@@ -364,7 +376,6 @@ bool SESAME::DStream::inspectChangedGrids() {
         mergeGridList(newGridList, adjustForTransitionalGrid(
                                        grid, characteristicVec, gridClass));
     }
-    gridIter++;
     a++;
   }
   // SESAME_INFO("Inspect changes in grids "<<gridList.size());
@@ -497,8 +508,8 @@ SESAME::HashMap SESAME::DStream::adjustNewLabels(SESAME::HashMap newGridList) {
       // b. for each OUTSIDE grid, dg, of c
       if (!inside) {
         // c. for each neighbouring grid, neighbourGrid, of dg
-
-        for (DensityGrid &neighbourGrid : grid.getNeighbours()) {
+        grid.getNeighbours(neighbours);
+        for (DensityGrid &neighbourGrid : neighbours) {
           if (newGridList.find(neighbourGrid) != newGridList.end()) {
             CharacteristicVector characteristicVec1 =
                 newGridList.find(neighbourGrid)->second;
@@ -582,8 +593,9 @@ SESAME::HashMap SESAME::DStream::adjustForDenseGrid(
 
   HashMap newGridList;
 
+  grid.getNeighbours(neighbours);
   for (DensityGrid &neighbourGrid :
-       grid.getNeighbours()) // The neighbour of g being considered
+       neighbours) // The neighbour of g being considered
   {
     if (this->gridList.find(neighbourGrid) != gridList.end()) {
       hClass = this->gridList.find(neighbourGrid)->second.label;
@@ -717,7 +729,8 @@ SESAME::HashMap SESAME::DStream::adjustForDenseGrid(
     // Iterate through the neighbourhood until no more transitional neighbours
     // can be added (dense neighbours will add themselves as part of their
     // adjust process)
-    for (DensityGrid &dghprime : grid.getNeighbours()) {
+    grid.getNeighbours(neighbours);
+    for (DensityGrid &dghprime : neighbours) {
       if (this->gridList.find(dghprime) != this->gridList.end() &&
           c.grids.find(dghprime) != c.grids.end()) {
         CharacteristicVector cvhprime = this->gridList.find(dghprime)->second;
@@ -768,7 +781,9 @@ SESAME::HashMap SESAME::DStream::adjustForTransitionalGrid(
                 << " adjust For Transitional Grid " << gridClass << ".");
   }
 
-  for (DensityGrid &neighbourGrid : grid.getNeighbours()) {
+  grid.getNeighbours(neighbours);
+
+  for (DensityGrid &neighbourGrid : neighbours) {
     if (this->gridList.find(neighbourGrid) != gridList.end()) {
       hClass = this->gridList.find(neighbourGrid)->second.label;
       ;
@@ -870,8 +885,8 @@ SESAME::HashMap SESAME::DStream::mergeNewClusters(SESAME::HashMap newGridList,
 bool SESAME::DStream::checkIfSporadic(CharacteristicVector characteristicVec) {
   // Check S1
   if (characteristicVec.getCurrGridDensity(currentTimeStamp, param.lambda) <
-      outlier_density_thresholdFunction(characteristicVec.densityUpdateTime,
-                                        param.cl, param.lambda, this->NGrids)) {
+      outlier_density_thresholdFunction(characteristicVec.updateTime, param.cl,
+                                        param.lambda, this->NGrids)) {
     // Check S2 TODO CHANGE REMOVE TIME FROM 0 TO -1
     if (characteristicVec.removeTime == 0 ||
         (currentTimeStamp -
@@ -882,6 +897,36 @@ bool SESAME::DStream::checkIfSporadic(CharacteristicVector characteristicVec) {
   return false;
 }
 
+/**
+ * Predicts the earliest time stamp at which the sporadic status of a grid can
+ * change without new data. A sporadic grid is due for deletion gap time stamps
+ * after its last update; a normal grid is due once both S1 and S2 hold.
+ */
+int SESAME::DStream::nextSporadicCheck(
+    const CharacteristicVector &characteristicVec) {
+  if (characteristicVec.isSporadic)
+    return characteristicVec.updateTime + gap;
+  if (param.lambda >= 1.0)
+    return INT_MAX;
+  // S1: D(tg) * lambda^(t - tg) < C * (1 - lambda^(t - tg + 1)), solved for t
+  double C = param.cl / (NGrids * (1.0 - param.lambda));
+  double densityAtUpdate =
+      characteristicVec.gridDensity *
+      pow(param.lambda, characteristicVec.updateTime -
+                            characteristicVec.densityUpdateTime);
+  double s1 = characteristicVec.updateTime +
+              floor(log(C / (densityAtUpdate + C * param.lambda)) /
+                    log(param.lambda));
+  // S2: t >= (1 + beta) * tm
+  double s2 = characteristicVec.removeTime == 0
+                  ? 0.0
+                  : floor((1 + param.beta) * characteristicVec.removeTime);
+  double due = max(s1, s2);
+  if (!(due < INT_MAX)) // also catches NaN from a degenerate C
+    return INT_MAX;
+  return (int)due;
+}
+
 /**
  * Implements the function pi given in Definition 4.1 of Chen and Tu 2007
  *
@@ -1050,53 +1095,33 @@ void SESAME::DStream::cleanClusters() {
  */
 void SESAME::DStream::removeSporadic() {
   // SESAME_INFO("REMOVE SPORADIC CALLED");
-  // For each grid g in grid_list
+  // For each grid g in grid_list which is due for a check
+  std::vector<DensityGrid> dueGrids;
+  if (sporadicRescan) {
+    sporadicQueue = GridEventQueue();
+    for (auto &gridIter : this->gridList)
+      dueGrids.push_back(gridIter.first);
+    sporadicRescan = false;
+  } else
+    dueGrids =
+        popDueGrids(sporadicQueue, &CharacteristicVector::sporadicDueTime);
 
-  HashMap newGridList;
   std::vector<DensityGrid> removeGridList;
-  for (auto &gridIter : this->gridList) {
-    const DensityGrid &grid = gridIter.first;
-    CharacteristicVector characteristicVec = gridIter.second;
-    // If g is sporadic
-    if (characteristicVec.isSporadic) {
-      // If currTime - tg > gap, delete g from grid_list
-      if (currentTimeStamp - characteristicVec.updateTime >= gap) {
-        int gridClass = characteristicVec.label;
-
-        if (gridClass != -1) {
-          for (auto gridCluster : clusterList) {
-            if (gridCluster.clusterLabel == gridClass) {
-              gridCluster.removeGrid(grid);
-            }
-          }
-        }
-        removeGridList.push_back(grid);
-      }
-      // Else if (S1 && S2), mark as sporadic - Else mark as normal
-      else {
-        characteristicVec.isSporadic = checkIfSporadic(characteristicVec);
-        // newGridList.insert(std::make_pair(grid, characteristicVec));
-        // newGridList= putHashMap(newGridList,grid, characteristicVec);
-        auto it1 = newGridList.find(grid);
-        if (it1 != newGridList.end())
-          it1->second = characteristicVec;
-        else
-          newGridList.insert(std::make_pair(grid, characteristicVec));
-      }
-    }
-    // Else if (S1 && S2), mark as sporadic
-    else {
-      characteristicVec.isSporadic = checkIfSporadic(characteristicVec);
-      // newGridList.insert(std::make_pair(grid, characteristicVec));
-      //  newGridList=  putHashMap(newGridList,grid, characteristicVec);
-      auto it1 = newGridList.find(grid);
-      if (it1 != newGridList.end())
-        it1->second = characteristicVec;
-      else
-        newGridList.insert(std::make_pair(grid, characteristicVec));
+  for (auto &grid : dueGrids) {
+    CharacteristicVector &characteristicVec = gridList.find(grid)->second;
+    // If g is sporadic and currTime - tg > gap, delete g from grid_list
+    if (characteristicVec.isSporadic &&
+        currentTimeStamp - characteristicVec.updateTime >= gap) {
+      removeGridList.push_back(grid);
+      continue;
     }
+    // Else if (S1 && S2), mark as sporadic - Else mark as normal
+    characteristicVec.isSporadic = checkIfSporadic(characteristicVec);
+    scheduleGrid(sporadicQueue, &CharacteristicVector::sporadicDueTime, grid,
+                 characteristicVec,
+                 max(nextSporadicCheck(characteristicVec),
+                     currentTimeStamp + 1));
   }
-  mergeGridList(gridList, newGridList);
 
   // SESAME_INFO(" - Removed "<<removeGridList.size()<<" grids from
   // grid_list.");
@@ -44,9 +44,11 @@ bool SESAME::CharacteristicVector::isTransitional(double dm, double dl) {
   else
     return false;
 }
+// gridDensity holds the density as of densityUpdateTime, so the decayed value
+// can be recomputed on demand and refreshing it is idempotent.
 double SESAME::CharacteristicVector::getCurrGridDensity(int NowTime,
                                                         double lambda) {
-  return pow(lambda, (NowTime - this->updateTime)) * this->gridDensity;
+  return pow(lambda, (NowTime - this->densityUpdateTime)) * this->gridDensity;
 }
 // Landmark window
 double SESAME::CharacteristicVector::getCurrGridDensity() {
@@ -122,4 +124,24 @@ void SESAME::CharacteristicVector::ChangeAttribute(double dl, double dm) {
     this->attribute = DENSE;
   else
     this->attribute = TRANSITIONAL;
+}
+
+int SESAME::CharacteristicVector::nextAttributeChange(double decayFactor,
+                                                      double dl,
+                                                      double dm) const {
+  double threshold;
+  if (this->attribute == DENSE)
+    threshold = dm;
+  else if (this->attribute == TRANSITIONAL)
+    threshold = dl;
+  else
+    return INT_MAX;
+  if (decayFactor >= 1.0 || threshold <= 0.0)
+    return INT_MAX;
+  if (this->gridDensity <= threshold)
+    return this->densityUpdateTime;
+  // Solve gridDensity * lambda^(t - densityUpdateTime) = threshold for t
+  double steps = floor(log(threshold / this->gridDensity) / log(decayFactor));
+  double due = this->densityUpdateTime + steps;
+  return due >= INT_MAX ? INT_MAX : (int)due;
 }
\ No newline at end of file
@@ -31,6 +31,12 @@ SESAME::SnapshotPtr SESAME::DataStructureFactory::createSnapshot(
     SESAME::MicroClusters &otherMicroClusters, int elapsedTime) {
   return std::make_shared<SESAME::Snapshot>(otherMicroClusters, elapsedTime);
 }
+SESAME::SnapshotPtr SESAME::DataStructureFactory::createSnapshot(
+    SESAME::MicroClusters &otherMicroClusters, int elapsedTime,
+    const SESAME::SnapshotPtr &previous) {
+  return std::make_shared<SESAME::Snapshot>(otherMicroClusters, elapsedTime,
+                                            previous);
+}
 
 void SESAME::DataStructureFactory::clearSnapshot(SESAME::SnapshotPtr Snapshot) {
   Snapshot.reset();
@@ -68,26 +74,3 @@ SESAME::DPTreePtr SESAME::DataStructureFactory::createDPTree(int num,
                                                              double r) {
   return std::make_shared<SESAME::DPTree>(num, r);
 }
-
-SESAME::MicroClusterPairPtr
-SESAME::DataStructureFactory::createMicroClusterPair(
-    MicroClusterPtr microCluster1, MicroClusterPtr microCluster2) {
-  return std::make_shared<SESAME::MicroClusterPair>(microCluster1,
-                                                    microCluster2);
-}
-
-void SESAME::DataStructureFactory::clearMicroClusterPair(
-    MicroClusterPairPtr microClusterPair) {
-  microClusterPair.reset();
-}
-
-SESAME::AdjustedWeightPtr
-SESAME::DataStructureFactory::createAdjustedWeight(double weight, int pointTime,
-                                                   timespec pointTime0) {
-  return std::make_shared<SESAME::AdjustedWeight>(weight, pointTime,
-                                                  pointTime0);
-}
-void SESAME::DataStructureFactory::clearAdjustedWeight(
-    SESAME::AdjustedWeightPtr adjustedWeight) {
-  adjustedWeight.reset();
-}
@@ -39,6 +39,17 @@ std::vector<SESAME::DensityGrid> SESAME::DensityGrid::getNeighbours() const {
   return neighbours;
 }
 
+void SESAME::DensityGrid::getNeighbours(
+    std::vector<DensityGrid> &neighbours) const {
+  neighbours.resize(2 * this->dims);
+  for (int i = 0; i < 2 * this->dims; i++) {
+    neighbours[i].dims = this->dims;
+    neighbours[i].coordinates.assign(this->coordinates.begin(),
+                                     this->coordinates.end());
+    neighbours[i].coordinates[i / 2] += i % 2 == 0 ? -1 : 1;
+  }
+}
+
 /**
  * Provides the probability of the argument instance belonging to the density
  * grid in question.
@@ -5,6 +5,8 @@
 #include <Algorithm/DataStructure/GridCluster.hpp>
 #include <Utils/Logger.hpp>
 
+#include <atomic>
+
 SESAME::GridCluster::GridCluster() {}
 SESAME::GridCluster::GridCluster(int label) { this->clusterLabel = label; }
 // TODO: if Using this function, be careful when grids are not NULL
@@ -87,13 +89,10 @@ void SESAME::GridCluster::absorbCluster(GridCluster gridCluster) {
  * @return TRUE if g is an inside grid, FALSE otherwise
  */
 bool SESAME::GridCluster::isInside(DensityGrid grid) {
-  std::vector<DensityGrid> neighbour = grid.getNeighbours();
-  for (auto gridNeighbourhood : neighbour) {
-    if (this->grids.find(gridNeighbourhood) == this->grids.end()) {
-      return false;
-    }
-  }
-  return true;
+  static thread_local DensityGrid probe;
+  return !grid.forEachNeighbour(probe, [&](const DensityGrid &neighbour) {
+    return this->grids.find(neighbour) == this->grids.end();
+  });
 }
 
 /**
@@ -107,14 +106,12 @@ bool SESAME::GridCluster::isInside(DensityGrid grid) {
  * @return TRUE if g would be an inside grid, FALSE otherwise
  */
 bool SESAME::GridCluster::isInside(DensityGrid grid, DensityGrid other) {
-  std::vector<DensityGrid> neighbour = grid.getNeighbours();
-  for (auto gridNeighbourhood : neighbour) {
-    if (this->grids.find(gridNeighbourhood) != this->grids.end() &&
-        gridNeighbourhood == other) {
-      return false;
-    }
-  }
-  return true;
+  static thread_local DensityGrid probe;
+  EqualGrid equal;
+  return !grid.forEachNeighbour(probe, [&](const DensityGrid &neighbour) {
+    return this->grids.find(neighbour) != this->grids.end() &&
+           equal(neighbour, other);
+  });
 }
 /**
  * Tests a grid cluster for connectedness according to Definition 3.4, Grid
@@ -135,20 +132,21 @@ bool SESAME::GridCluster::isConnected() {
     putHashGrid(this->visited, grid, this->grids.begin()->second);
     bool changesMade;
 
+    DensityGrid probe;
     do {
       changesMade = false;
       auto visIter = this->visited.begin();
       HashGrids toAdd;
 
       while (visIter != this->visited.end() && toAdd.empty()) {
-        DensityGrid dg2V = visIter->first;
-        std::vector<DensityGrid> neighbour = dg2V.getNeighbours();
-        for (auto dg2VNeighbourhood : neighbour) {
-          if (this->grids.find(dg2VNeighbourhood) != this->grids.end() &&
-              this->visited.find(dg2VNeighbourhood) == this->visited.end())
-            putHashGrid(toAdd, dg2VNeighbourhood,
-                        this->grids.find(dg2VNeighbourhood)->second);
-        }
+        visIter->first.forEachNeighbour(
+            probe, [&](const DensityGrid &dg2VNeighbourhood) {
+              if (this->grids.find(dg2VNeighbourhood) != this->grids.end() &&
+                  this->visited.find(dg2VNeighbourhood) == this->visited.end())
+                putHashGrid(toAdd, dg2VNeighbourhood,
+                            this->grids.find(dg2VNeighbourhood)->second);
+              return false;
+            });
         visIter++;
       }
 
@@ -200,7 +198,7 @@ bool SESAME::GridCluster::operator==(GridCluster &other) const {
   return equal;
 }
 
-void SESAME::GridCluster::putHashGrid(HashGrids grids1, const DensityGrid &g,
+void SESAME::GridCluster::putHashGrid(HashGrids &grids1, const DensityGrid &g,
                                       bool inside) {
   auto it1 = grids1.find(g);
   if (it1 != grids1.end())
@@ -208,3 +206,101 @@ void SESAME::GridCluster::putHashGrid(HashGrids grids1, const DensityGrid &g,
   else
     grids1.insert(std::make_pair(g, inside));
 }
+
+namespace {
+// Union-find over grid slots that tolerates concurrent unions. A parent always
+// has a smaller slot than its child, so every root is the smallest slot of its
+// component regardless of the order in which unions happen.
+int findRoot(std::vector<std::atomic<int>> &parent, int slot) {
+  while (true) {
+    int up = parent[slot].load(std::memory_order_relaxed);
+    if (up == slot)
+      return slot;
+    int upper = parent[up].load(std::memory_order_relaxed);
+    if (upper != up) // path halving
+      parent[slot].compare_exchange_weak(up, upper, std::memory_order_relaxed);
+    slot = upper;
+  }
+}
+
+void unite(std::vector<std::atomic<int>> &parent, int slot1, int slot2) {
+  while (true) {
+    slot1 = findRoot(parent, slot1);
+    slot2 = findRoot(parent, slot2);
+    if (slot1 == slot2)
+      return;
+    if (slot1 > slot2)
+      std::swap(slot1, slot2);
+    int root = slot2;
+    if (parent[slot2].compare_exchange_strong(root, slot1,
+                                              std::memory_order_relaxed))
+      return;
+  }
+}
+} // namespace
+
+std::vector<SESAME::GridCluster>
+SESAME::GridCluster::connectedClusters(HashMap &gridList) {
+  // Only dense and transitional grids take part, their label holds their slot
+  // while the components are computed
+  std::vector<HashMap::iterator> slots;
+  for (auto iter = gridList.begin(); iter != gridList.end(); iter++) {
+    if (iter->second.attribute == SPARSE) {
+      iter->second.label = NO_CLASS;
+    } else {
+      iter->second.label = (int)slots.size();
+      slots.push_back(iter);
+    }
+  }
+  const int n = (int)slots.size();
+  std::vector<std::atomic<int>> parent(n);
+  for (int i = 0; i < n; i++)
+    parent[i].store(i, std::memory_order_relaxed);
+
+#pragma omp parallel
+  {
+    DensityGrid probe;
+#pragma omp for schedule(dynamic, 256)
+    for (int i = 0; i < n; i++) {
+      // Every edge is seen from both ends, only unite it from the smaller slot
+      slots[i]->first.forEachNeighbour(probe, [&](const DensityGrid &grid) {
+        auto iter = gridList.find(grid);
+        if (iter != gridList.end() && iter->second.attribute != SPARSE &&
+            iter->second.label > i)
+          unite(parent, i, iter->second.label);
+        return false;
+      });
+    }
+  }
+
+  std::vector<int> roots(n);
+#pragma omp parallel for
+  for (int i = 0; i < n; i++)
+    roots[i] = findRoot(parent, i);
+  std::vector<char> hasDense(n, false);
+  for (int i = 0; i < n; i++) {
+    if (slots[i]->second.attribute == DENSE)
+      hasDense[roots[i]] = true;
+  }
+  // Number the components in slot order, so that labels are deterministic
+  std::vector<int> clusterOf(n, NO_CLASS);
+  std::vector<GridCluster> clusters;
+  for (int i = 0; i < n; i++) {
+    if (roots[i] == i && hasDense[i]) {
+      clusterOf[i] = (int)clusters.size();
+      clusters.emplace_back((int)clusters.size());
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    int label = clusterOf[roots[i]];
+    slots[i]->second.label = label;
+    if (label != NO_CLASS)
+      clusters[label].grids.insert(std::make_pair(slots[i]->first, false));
+  }
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < (int)clusters.size(); i++) {
+    for (auto &grid : clusters[i].grids)
+      grid.second = clusters[i].isInside(grid.first);
+  }
+  return clusters;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#include <Algorithm/DataStructure/KMeansPPSeeder.hpp>
+#include <Algorithm/DataStructure/PointMatrix.hpp>
+#include <algorithm>
+#include <limits>
+
+SESAME::KMeansPPSeeder::KMeansPPSeeder(const std::vector<PointPtr> &points,
+                                       const std::vector<double> &weights) {
+  int size = (int)points.size();
+  this->dim = size == 0 ? 0 : points.front()->getDimension();
+  this->weights = weights.empty() ? std::vector<double>(size, 1.0) : weights;
+  coordinates = flattenPoints(points, dim);
+  minDistances.assign(size, std::numeric_limits<double>::max());
+}
+
+void SESAME::KMeansPPSeeder::addCentre(const PointPtr &centre) {
+  const double *feature = centre->data();
+  const double *point = coordinates.data();
+  prefix.resize(minDistances.size());
+  double sum = 0;
+  for (size_t i = 0; i < minDistances.size(); i++, point += dim) {
+    minDistances[i] =
+        std::min(minDistances[i], squaredDistance(point, feature, dim));
+    sum += minDistances[i] * weights[i];
+    prefix[i] = sum;
+  }
+}
+
+int SESAME::KMeansPPSeeder::sample(double u) const {
+  // a point without mass never owns a draw: u <= 0 goes to the first point
+  // with mass rather than to the first point
+  auto it = u > 0 ? std::lower_bound(prefix.begin(), prefix.end(), u)
+                  : std::upper_bound(prefix.begin(), prefix.end(), 0.0);
+  return it == prefix.end() ? -1 : (int)(it - prefix.begin());
+}
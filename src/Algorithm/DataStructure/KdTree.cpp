@@ -0,0 +1,132 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#include <Algorithm/DataStructure/KdTree.hpp>
+#include <Algorithm/DataStructure/PointMatrix.hpp>
+#include <algorithm>
+#include <cmath>
+
+SESAME::KdTree::KdTree(const std::vector<PointPtr> &points,
+                       const std::vector<int> &members)
+    : ids(members) {
+  int size = (int)members.size();
+  this->dim = size == 0 ? 0 : points[members.front()]->getDimension();
+  coordinates = flattenPoints(points, members, dim);
+  if (size > 0)
+    build(0, size);
+}
+
+int SESAME::KdTree::build(int begin, int end) {
+  int index = (int)nodes.size();
+  nodes.push_back(Node{begin, end});
+  if (end - begin <= LEAF_SIZE)
+    return index;
+
+  int splitDim = 0;
+  double maxSpread = -1;
+  for (int j = 0; j < dim; j++) {
+    double minVal = INFINITY, maxVal = -INFINITY;
+    for (int i = begin; i < end; i++) {
+      minVal = std::min(minVal, coordinates[(size_t)i * dim + j]);
+      maxVal = std::max(maxVal, coordinates[(size_t)i * dim + j]);
+    }
+    if (maxVal - minVal > maxSpread) {
+      maxSpread = maxVal - minVal;
+      splitDim = j;
+    }
+  }
+  if (!(maxSpread > 0)) // all members coincide
+    return index;
+
+  // Partition the rows around the median of the split dim
+  int mid = begin + (end - begin) / 2;
+  std::vector<int> order(end - begin);
+  for (int i = begin; i < end; i++)
+    order[i - begin] = i;
+  std::nth_element(order.begin(), order.begin() + (mid - begin), order.end(),
+                   [&](int a, int b) {
+                     return coordinates[(size_t)a * dim + splitDim] <
+                            coordinates[(size_t)b * dim + splitDim];
+                   });
+  std::vector<double> rows((size_t)(end - begin) * dim);
+  std::vector<int> rowIds(end - begin);
+  for (int i = 0; i < end - begin; i++) {
+    std::copy_n(&coordinates[(size_t)order[i] * dim], dim,
+                &rows[(size_t)i * dim]);
+    rowIds[i] = ids[order[i]];
+  }
+  std::copy(rows.begin(), rows.end(), &coordinates[(size_t)begin * dim]);
+  std::copy(rowIds.begin(), rowIds.end(), ids.begin() + begin);
+
+  nodes[index].dim = splitDim;
+  nodes[index].split = coordinates[(size_t)mid * dim + splitDim];
+  int left = build(begin, mid);
+  int right = build(mid, end);
+  nodes[index].left = left;
+  nodes[index].right = right;
+  return index;
+}
+
+void SESAME::KdTree::nearest(const PointPtr &query, int k, int skip,
+                             std::vector<double> &dists) const {
+  dists.clear();
+  if (!nodes.empty() && k > 0)
+    search(0, query->data(), k, skip, dists);
+  for (auto &dist : dists)
+    dist = std::sqrt(dist);
+}
+
+void SESAME::KdTree::search(int node, const double *query, int k, int skip,
+                            std::vector<double> &dists) const {
+  // dists holds the squared distances found so far, in increasing order
+  const Node &current = nodes[node];
+  if (current.dim < 0) {
+    for (int i = current.begin; i < current.end; i++) {
+      if (ids[i] == skip)
+        continue;
+      double dist = squaredDistance(&coordinates[(size_t)i * dim], query, dim);
+      if ((int)dists.size() == k) {
+        if (!(dist < dists.back()))
+          continue;
+        dists.pop_back();
+      }
+      dists.insert(std::upper_bound(dists.begin(), dists.end(), dist), dist);
+    }
+    return;
+  }
+  // Members left of the split are not above it, those right not below it
+  double diff = query[current.dim] - current.split;
+  int nearChild = diff < 0 ? current.left : current.right;
+  int farChild = diff < 0 ? current.right : current.left;
+  search(nearChild, query, k, skip, dists);
+  if ((int)dists.size() < k || diff * diff <= dists.back())
+    search(farChild, query, k, skip, dists);
+}
+
+void SESAME::KdTree::rangeQuery(const PointPtr &query, double radius,
+                                std::vector<int> &members) const {
+  members.clear();
+  if (!nodes.empty())
+    searchRange(0, query->data(), radius * radius, members);
+  std::sort(members.begin(), members.end());
+}
+
+void SESAME::KdTree::searchRange(int node, const double *query,
+                                 double radiusSquared,
+                                 std::vector<int> &members) const {
+  const Node &current = nodes[node];
+  if (current.dim < 0) {
+    for (int i = current.begin; i < current.end; i++) {
+      if (squaredDistance(&coordinates[(size_t)i * dim], query, dim) <=
+          radiusSquared)
+        members.push_back(ids[i]);
+    }
+    return;
+  }
+  double diff = query[current.dim] - current.split;
+  int nearChild = diff < 0 ? current.left : current.right;
+  int farChild = diff < 0 ? current.right : current.left;
+  searchRange(nearChild, query, radiusSquared, members);
+  if (diff * diff <= radiusSquared)
+    searchRange(farChild, query, radiusSquared, members);
+}
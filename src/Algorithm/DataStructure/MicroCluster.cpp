@@ -7,7 +7,13 @@
 #include <Algorithm/DataStructure/DataStructureFactory.hpp>
 #include <Algorithm/DataStructure/MicroCluster.hpp>
 #include <Utils/Logger.hpp>
+#include <atomic>
 #include <iterator>
+
+namespace {
+std::atomic<uint64_t> nextVersion(0);
+} // namespace
+
 // Create MC, only initialization, used for DenStream, CluStream
 SESAME::MicroCluster::MicroCluster(int dim, int id) {
   this->dim = dim;
@@ -20,6 +26,7 @@ SESAME::MicroCluster::MicroCluster(int dim, int id) {
   this->lastUpdateTime = this->createTime;
   radius = 0;
   visited = false;
+  touch();
 }
 
 // Create MC, only initialization, only used for DBStream as it has user-defined
@@ -41,6 +48,7 @@ SESAME::MicroCluster::MicroCluster(int dim, int id, PointPtr dataPoint,
     LS.push_back(data);
     centroid.push_back(data);
   }
+  touch();
 }
 
 // Release memory of the current micro cluster
@@ -64,6 +72,7 @@ void SESAME::MicroCluster::Init(PointPtr datapoint, int timestamp) {
   this->createTime = datapoint->getIndex();
   LST += timestamp;
   SST += timestamp * timestamp;
+  touch();
 }
 
 // Used in DenStream, DBStream
@@ -78,6 +87,7 @@ void SESAME::MicroCluster::insert(PointPtr datapoint, int timestamp) {
   LST += timestamp;
   SST += timestamp * timestamp;
   centroid = std::move(getCentroid());
+  touch();
 }
 
 // Used only in DBStream
@@ -90,6 +100,7 @@ void SESAME::MicroCluster::insert(PointPtr datapoint) //,double decayFactor
     LS[i] = centroid.at(i) + val * (data - centroid.at(i));
   }
   lastUpdateTime = datapoint->getIndex();
+  touch();
 }
 
 double SESAME::MicroCluster::getDistance(PointPtr datapoint) {
@@ -131,6 +142,7 @@ bool SESAME::MicroCluster::insert(PointPtr datapoint, double decayFactor,
       centroid.at(i) = LS.at(i) / weight;
     }
     this->lastUpdateTime = datapoint->getIndex();
+    touch();
     result = true;
   } else
     result = false;
@@ -149,6 +161,7 @@ void SESAME::MicroCluster::merge(MicroClusterPtr other) {
   SST += other->SST;
   updateId(other);
   centroid = std::move(getCentroid());
+  touch();
 }
 
 // Calculate the process of micro cluster N(Tc-h')
@@ -161,6 +174,7 @@ void SESAME::MicroCluster::subtractClusterVector(MicroClusterPtr other) {
   this->LST -= other->LST;
   this->SST -= other->SST;
   centroid = std::move(getCentroid());
+  touch();
 }
 bool SESAME::MicroCluster::judgeMerge(MicroClusterPtr other) {
   bool merge = true;
@@ -178,12 +192,15 @@ void SESAME::MicroCluster::updateId(MicroClusterPtr other) {
   }
   std::vector<int>().swap(other->id);
   this->id.reserve(20);
+  other->touch();
+  touch();
 }
 
 // reset the unique id in MICRO CLUSTER OF DENSTREAM
 void SESAME::MicroCluster::resetID(int index) {
   this->id.pop_back();
   this->id.push_back(index);
+  touch();
 }
 
 // obtain relevance stamp of a cluster to judge whether it needs to be deleted
@@ -314,10 +331,21 @@ double SESAME::MicroCluster::calCentroidDistance(PointPtr datapoint) {
 }
 
 // Still need to modify
-void SESAME::MicroCluster::move() { this->centroid = this->LS; }
+void SESAME::MicroCluster::move() {
+  this->centroid = this->LS;
+  touch();
+}
 
 void SESAME::MicroCluster::decayWeight(double decayFactor) {
   this->weight *= decayFactor;
+  touch();
+}
+
+void SESAME::MicroCluster::stamp() {
+  if (!changed)
+    return;
+  version = nextVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+  changed = false;
 }
 double SESAME::MicroCluster::inverseError(double x) {
   double z = sqrt(M_PI) * x;
@@ -0,0 +1,49 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#include <Algorithm/DataStructure/MicroClusterStore.hpp>
+#include <Algorithm/DataStructure/PointMatrix.hpp>
+#include <limits>
+
+SESAME::MicroClusterStore::MicroClusterStore() = default;
+
+SESAME::MicroClusterStore::MicroClusterStore(int dim) { this->dim = dim; }
+
+void SESAME::MicroClusterStore::add(const MicroClusterPtr &microCluster) {
+  microClusters.push_back(microCluster);
+  centroids.insert(centroids.end(), microCluster->centroid.begin(),
+                   microCluster->centroid.begin() + dim);
+}
+
+void SESAME::MicroClusterStore::syncCentroid(size_t index) {
+  std::copy(microClusters[index]->centroid.begin(),
+            microClusters[index]->centroid.begin() + dim,
+            centroids.begin() + index * dim);
+}
+
+void SESAME::MicroClusterStore::remove(size_t index) {
+  size_t last = microClusters.size() - 1;
+  if (index != last) {
+    microClusters[index] = std::move(microClusters[last]);
+    std::copy(centroids.begin() + last * dim, centroids.end(),
+              centroids.begin() + index * dim);
+  }
+  microClusters.pop_back();
+  centroids.resize(last * dim);
+}
+
+size_t SESAME::MicroClusterStore::nearest(const PointPtr &point) const {
+  const double *feature = point->data();
+  const double *centroid = centroids.data();
+  size_t target = microClusters.size();
+  double minDist = std::numeric_limits<double>::max();
+  for (size_t i = 0; i < microClusters.size(); i++, centroid += dim) {
+    // Squared distances rank the centroids the same as distances
+    double dist = squaredDistance(centroid, feature, dim);
+    if (dist < minDist) {
+      minDist = dist;
+      target = i;
+    }
+  }
+  return target;
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#include <Algorithm/DataStructure/PointGridIndex.hpp>
+#include <Algorithm/DataStructure/PointMatrix.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Cell coordinates are packed into 21 bits per grid dim; clamping keeps the
+// neighbouring cells of a query a superset of the points within radius
+constexpr int CELL_BITS = 21;
+constexpr int CELL_MAX = (1 << CELL_BITS) - 1;
+} // namespace
+
+SESAME::PointGridIndex::PointGridIndex(const std::vector<PointPtr> &points,
+                                       double radius) {
+  int size = (int)points.size();
+  this->dim = size == 0 ? 0 : points.front()->getDimension();
+  this->radius = radius;
+  coordinates = flattenPoints(points, dim);
+
+  // Lay the cells over the dims with the largest spread, skipping dims too
+  // narrow to separate any points
+  std::vector<double> minVals(dim, INFINITY), maxVals(dim, -INFINITY);
+  for (int i = 0; i < size; i++)
+    for (int j = 0; j < dim; j++) {
+      minVals[j] = std::min(minVals[j], coordinates[(size_t)i * dim + j]);
+      maxVals[j] = std::max(maxVals[j], coordinates[(size_t)i * dim + j]);
+    }
+  std::vector<int> bySpread(dim);
+  for (int j = 0; j < dim; j++)
+    bySpread[j] = j;
+  std::stable_sort(bySpread.begin(), bySpread.end(), [&](int a, int b) {
+    return maxVals[a] - minVals[a] > maxVals[b] - minVals[b];
+  });
+  for (int j : bySpread) {
+    if ((int)gridDims.size() == GRID_DIMS || !(radius > 0) ||
+        !(maxVals[j] - minVals[j] > radius))
+      break;
+    gridDims.push_back(j);
+    origin.push_back(minVals[j]);
+  }
+
+  std::vector<std::pair<uint64_t, int>> cells(size);
+  int cell[GRID_DIMS];
+  for (int i = 0; i < size; i++) {
+    cellOf(i, cell);
+    cells[i] = std::make_pair(cellKey(cell), i);
+  }
+  std::sort(cells.begin(), cells.end());
+  keys.resize(size);
+  order.resize(size);
+  for (int i = 0; i < size; i++) {
+    keys[i] = cells[i].first;
+    order[i] = cells[i].second;
+  }
+}
+
+uint64_t SESAME::PointGridIndex::cellKey(const int *cell) const {
+  uint64_t key = 0;
+  for (size_t g = 0; g < gridDims.size(); g++)
+    key = (key << CELL_BITS) | (uint64_t)cell[g];
+  return key;
+}
+
+void SESAME::PointGridIndex::cellOf(int index, int *cell) const {
+  for (size_t g = 0; g < gridDims.size(); g++) {
+    double offset =
+        (coordinates[(size_t)index * dim + gridDims[g]] - origin[g]) / radius;
+    cell[g] = (int)std::min<double>(std::floor(offset), CELL_MAX);
+  }
+}
+
+void SESAME::PointGridIndex::rangeQuery(int index,
+                                        std::vector<int> &neighbours) const {
+  neighbours.clear();
+  const double *center = &coordinates[(size_t)index * dim];
+  double radiusSquared = radius * radius;
+  int home[GRID_DIMS], cell[GRID_DIMS];
+  cellOf(index, home);
+  int numCells = 1;
+  for (size_t g = 0; g < gridDims.size(); g++)
+    numCells *= 3;
+  // Visit the 3^g cells around the home cell, offsets -1, 0, +1 per grid dim
+  for (int code = 0; code < numCells; code++) {
+    bool inside = true;
+    for (size_t g = 0, rest = code; g < gridDims.size(); g++, rest /= 3) {
+      cell[g] = home[g] + (int)(rest % 3) - 1;
+      inside = inside && cell[g] >= 0 && cell[g] <= CELL_MAX;
+    }
+    if (!inside)
+      continue;
+    auto range = std::equal_range(keys.begin(), keys.end(), cellKey(cell));
+    for (auto it = range.first; it != range.second; ++it) {
+      int other = order[it - keys.begin()];
+      const double *point = &coordinates[(size_t)other * dim];
+      if (squaredDistance(point, center, dim) <= radiusSquared)
+        neighbours.push_back(other);
+    }
+  }
+  std::sort(neighbours.begin(), neighbours.end());
+}
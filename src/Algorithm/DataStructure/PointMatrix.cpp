@@ -0,0 +1,23 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#include <Algorithm/DataStructure/PointMatrix.hpp>
+
+std::vector<double> SESAME::flattenPoints(const std::vector<PointPtr> &points,
+                                          int dim) {
+  std::vector<double> rows(points.size() * dim);
+  for (size_t i = 0; i < points.size(); i++)
+    for (int j = 0; j < dim; j++)
+      rows[i * dim + j] = points[i]->getFeatureItem(j);
+  return rows;
+}
+
+std::vector<double> SESAME::flattenPoints(const std::vector<PointPtr> &points,
+                                          const std::vector<int> &members,
+                                          int dim) {
+  std::vector<double> rows(members.size() * dim);
+  for (size_t i = 0; i < members.size(); i++)
+    for (int j = 0; j < dim; j++)
+      rows[i * dim + j] = points[members[i]]->getFeatureItem(j);
+  return rows;
+}
@@ -12,47 +12,46 @@
 SESAME::Snapshot::Snapshot(MicroClusters &otherMicroClusters, int elapsedTime) {
   this->elapsedTime = elapsedTime;
   for (int a = 0; a < otherMicroClusters.size(); a++) {
+    otherMicroClusters[a]->stamp();
     this->microClusters.push_back(otherMicroClusters[a]->copy());
   }
 }
+SESAME::Snapshot::Snapshot(MicroClusters &otherMicroClusters, int elapsedTime,
+                           const SnapshotPtr &previous) {
+  this->elapsedTime = elapsedTime;
+  this->microClusters.reserve(otherMicroClusters.size());
+  for (size_t a = 0; a < otherMicroClusters.size(); a++) {
+    otherMicroClusters[a]->stamp();
+    if (previous && a < previous->microClusters.size() &&
+        previous->microClusters[a]->version == otherMicroClusters[a]->version)
+      this->microClusters.push_back(previous->microClusters[a]);
+    else
+      this->microClusters.push_back(otherMicroClusters[a]->copy());
+  }
+}
 SESAME::Snapshot::~Snapshot() {
   std::vector<MicroClusterPtr>().swap(this->microClusters);
 }
 SESAME::SnapshotPtr
-SESAME::Snapshot::findSnapshot(QueueOrderSnapshot orderSnapShots,
+SESAME::Snapshot::findSnapshot(const QueueOrderSnapshot &orderSnapShots,
                                int landmarkTime, int currentElapsedTime,
                                unsigned int currentOrder) {
-  int i = 0;
+  SnapshotPtr nearestSnapshot;
   int minDistance = currentElapsedTime;
   int dist, tempMinDistance = -1, elapsedTimeSnapshot;
-  int finalOrder, indexSnapshot; // the index of found snapshotPtr
-  // Found snapshotPtr
-  while (i <= currentOrder) {
-    for (int a = 0; a < orderSnapShots[i].size(); a++) {
-      elapsedTimeSnapshot = orderSnapShots[i][a]->elapsedTime;
+  for (unsigned int i = 0; i <= currentOrder && i < orderSnapShots.size();
+       i++) {
+    for (const SnapshotPtr &snapshot : orderSnapShots[i]) {
+      elapsedTimeSnapshot = snapshot->elapsedTime;
       dist = abs((int)(elapsedTimeSnapshot - landmarkTime));
       if (minDistance > dist ||
-          (minDistance == dist && tempMinDistance < elapsedTimeSnapshot)) //
-      {
+          (minDistance == dist && tempMinDistance < elapsedTimeSnapshot)) {
         minDistance = dist;
         tempMinDistance = elapsedTimeSnapshot;
-        finalOrder = i;
-        indexSnapshot = a;
-        //        SESAME_INFO(" this one Elapsed Time is "<<
-        //        elapsedTimeSnapshot<<",elapsed time is "<<tempMinDistance);
-        // SESAME_INFO(" in order  "<< finalOrder<<",  "<<tempMinDistance<<"th
-        // snapshots shared ptr");
+        nearestSnapshot = snapshot;
       }
     }
-    i++;
   }
-
-  SnapshotPtr nearestSnapshot = DataStructureFactory::createSnapshot(
-      orderSnapShots[finalOrder][indexSnapshot]->microClusters,
-      orderSnapShots[finalOrder][indexSnapshot]->elapsedTime);
-  // SESAME_INFO("close landmark "<< tempMinDistance);
-  // SESAME_INFO("just for contrast : "<<
-  // orderSnapShots[finalOrder][indexSnapshot]->elapsedTime);
   return nearestSnapshot;
 }
 SESAME::SnapshotPtr
@@ -32,3 +32,82 @@ void SESAME::AdjustedWeight::add(int startTime, double decayValue) {
 double SESAME::AdjustedWeight::getCurrentWeight(double decayFactor) {
   return weight * decayFactor;
 }
+
+/**
+ * Linear probing from the key's hash position
+ * @return the slot holding the key, or the empty slot ending its probe
+ * sequence
+ */
+size_t SESAME::WeightedAdjacencyList::slotOf(Key key) const {
+  size_t mask = slots.size() - 1;
+  size_t slot = homeSlot(key);
+  while (slots[slot].key != key && slots[slot].key != EMPTY)
+    slot = (slot + 1) & mask;
+  return slot;
+}
+
+SESAME::AdjustedWeight *SESAME::WeightedAdjacencyList::find(int id1, int id2) {
+  if (used == 0)
+    return nullptr;
+  Slot &slot = slots[slotOf(pairKey(id1, id2))];
+  return slot.key == EMPTY ? nullptr : &slot.weight;
+}
+
+SESAME::AdjustedWeight &
+SESAME::WeightedAdjacencyList::insert(int id1, int id2,
+                                      const AdjustedWeight &weight) {
+  // Keep at least a quarter of the slots empty so that probes stay short
+  if ((used + deleted + 1) * 4 > slots.size() * 3) {
+    // Grow unless dropping the tombstones frees enough room
+    size_t capacity = std::max<size_t>(16, slots.size());
+    while ((used + 1) * 2 > capacity)
+      capacity *= 2;
+    rehash(capacity);
+  }
+  Key key = pairKey(id1, id2);
+  size_t mask = slots.size() - 1;
+  size_t slot = homeSlot(key);
+  while (slots[slot].key < DELETED)
+    slot = (slot + 1) & mask;
+  if (slots[slot].key == DELETED)
+    deleted--;
+  slots[slot].key = key;
+  slots[slot].weight = weight;
+  used++;
+  return slots[slot].weight;
+}
+
+void SESAME::WeightedAdjacencyList::erase(int id1, int id2) {
+  if (used == 0)
+    return;
+  Slot &slot = slots[slotOf(pairKey(id1, id2))];
+  if (slot.key != EMPTY) {
+    slot.key = DELETED;
+    used--;
+    deleted++;
+  }
+}
+
+void SESAME::WeightedAdjacencyList::clear() {
+  slots.clear();
+  used = 0;
+  deleted = 0;
+}
+
+/**
+ * Move all edges into a table of the given capacity, dropping tombstones
+ */
+void SESAME::WeightedAdjacencyList::rehash(size_t capacity) {
+  std::vector<Slot> old(capacity);
+  old.swap(slots);
+  deleted = 0;
+  size_t mask = capacity - 1;
+  for (auto &entry : old) {
+    if (entry.key >= DELETED)
+      continue;
+    size_t slot = homeSlot(entry.key);
+    while (slots[slot].key != EMPTY)
+      slot = (slot + 1) & mask;
+    slots[slot] = entry;
+  }
+}
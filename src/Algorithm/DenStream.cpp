@@ -17,47 +17,63 @@ SESAME::DenStream::DenStream(param_t &cmd_params) {
   this->denStreamParams.mu = cmd_params.mu;
   this->denStreamParams.beta = cmd_params.beta;
   this->denStreamParams.buf_sizeSize = cmd_params.buf_size;
+  this->pMicroClusters = MicroClusterStore(cmd_params.dim);
+  this->oMicroClusters = MicroClusterStore(cmd_params.dim);
 }
 SESAME::DenStream::~DenStream() {}
 
 void SESAME::DenStream::Init(vector<PointPtr> &initData) {
   this->pMicroClusterIndex = -1;
   this->oMicroClusterIndex = -1;
-  for (int i = 0; i < denStreamParams.buf_sizeSize; i++) {
-    if (initData.at(i)->getClusteringCenter() == noVisited) {
-      std::vector<int> pointIndex;
-      pMicroClusterIndex++;
-      MicroClusterPtr newMicroCluster =
-          SESAME::DataStructureFactory::createMicroCluster(denStreamParams.dim,
-                                                           pMicroClusterIndex);
-      newMicroCluster->Init(initData.at(i), 0);
-      pointsNearCorePoint(initData, pointIndex, newMicroCluster);
-      if (newMicroCluster->weight <=
-          this->minWeight) // TODO need to change minweight
-      {
-        pMicroClusterIndex--;
-        for (int index : pointIndex) {
-          initData.at(index)->setClusteringCenter(noVisited);
-        }
-      } else
-        pMicroClusters.push_back(newMicroCluster);
+  int size = denStreamParams.buf_sizeSize;
+  PointGridIndex gridIndex(initData, denStreamParams.epsilon);
+  std::vector<std::vector<int>> neighbourhoods(INIT_BLOCK);
+  for (int begin = 0; begin < size; begin += INIT_BLOCK) {
+    int end = std::min(size, begin + INIT_BLOCK);
+    // Find the ε-neighbourhoods of the block's unvisited points in parallel,
+    // then grow the micro clusters from them in order
+#pragma omp parallel for schedule(dynamic)
+    for (int i = begin; i < end; i++) {
+      if (initData.at(i)->getClusteringCenter() == noVisited)
+        gridIndex.rangeQuery(i, neighbourhoods[i - begin]);
+    }
+    for (int i = begin; i < end; i++) {
+      if (initData.at(i)->getClusteringCenter() == noVisited) {
+        std::vector<int> pointIndex;
+        pMicroClusterIndex++;
+        MicroClusterPtr newMicroCluster =
+            SESAME::DataStructureFactory::createMicroCluster(
+                denStreamParams.dim, pMicroClusterIndex);
+        newMicroCluster->Init(initData.at(i), 0);
+        pointsNearCorePoint(initData, neighbourhoods[i - begin], pointIndex,
+                            newMicroCluster);
+        if (newMicroCluster->weight <=
+            this->minWeight) // TODO need to change minweight
+        {
+          pMicroClusterIndex--;
+          for (int index : pointIndex) {
+            initData.at(index)->setClusteringCenter(noVisited);
+          }
+        } else
+          pMicroClusters.add(newMicroCluster);
+      }
     }
   }
   SESAME_INFO("NOW PMC number is: " << this->pMicroClusterIndex
                                     << " , Init succeed!");
 }
-void SESAME::DenStream::pointsNearCorePoint(vector<PointPtr> &initData,
-                                            std::vector<int> pointIndex,
-                                            MicroClusterPtr microCluster) {
-  int size = denStreamParams.buf_sizeSize;
-  for (int i = 0; i < size; i++) {
+/**
+ * Absorb the unvisited points of the core point's ε-neighbourhood into its
+ * micro cluster, recording their indices in pointIndex for a roll-back
+ */
+void SESAME::DenStream::pointsNearCorePoint(
+    vector<PointPtr> &initData, const std::vector<int> &neighbourhood,
+    std::vector<int> &pointIndex, MicroClusterPtr microCluster) {
+  for (int i : neighbourhood) {
     if (initData.at(i)->getClusteringCenter() == noVisited) {
-      double dist = microCluster->calCentroidDistance(initData.at(i));
-      if (dist < denStreamParams.epsilon) {
-        initData[i]->setClusteringCenter(microCluster->id.front());
-        microCluster->insert(initData.at(i), 0);
-        pointIndex.push_back(i);
-      }
+      initData[i]->setClusteringCenter(microCluster->id.front());
+      microCluster->insert(initData.at(i), 0);
+      pointIndex.push_back(i);
     }
   }
 }
@@ -99,30 +115,20 @@ void SESAME::DenStream::RunOnline(PointPtr in) {
       // timerMeter.outlierDetectionAccMeasure();
       // SESAME_INFO("Check "<<elapsedTime);
 
-      for (int iter = 0; iter < pMicroClusters.size(); iter++) {
-        if (pMicroClusters.at(iter)->weight < minWeight) {
-          pMicroClusters.erase(pMicroClusters.begin() + iter);
-          // SESAME_INFO("NOW PMC number is: " << this->pMicroClusterIndex);
-        }
-      }
+      pMicroClusters.removeIf([&](const MicroClusterPtr &microCluster) {
+        return microCluster->weight < minWeight;
+      });
       // timerMeter.outlierDetectionEndMeasure();
 
-      if (!oMicroClusters.empty()) {
-        for (int iter = 0; iter < oMicroClusters.size(); iter++) {
-          double a = -(denStreamParams.lambda) *
-                     (pointArrivingTime - oMicroClusters.at(iter)->createTime +
-                      this->Tp);
-          double b = -denStreamParams.lambda * this->Tp;
-          double Xi = (pow(denStreamParams.base, a) - 1) /
-                      (pow(denStreamParams.base, b) - 1);
-          // SESAME_INFO("NOW Xi  "<<Xi);
-          if (oMicroClusters.at(iter)->weight < Xi) {
-            oMicroClusters.erase(oMicroClusters.begin() + iter);
-            // SESAME_INFO("NOW oMicroClusterIndex number is: " <<
-            // oMicroClusters.size());
-          }
-        }
-      }
+      double b = -denStreamParams.lambda * this->Tp;
+      oMicroClusters.removeIf([&](const MicroClusterPtr &microCluster) {
+        double a = -(denStreamParams.lambda) *
+                   (pointArrivingTime - microCluster->createTime + this->Tp);
+        double Xi = (pow(denStreamParams.base, a) - 1) /
+                    (pow(denStreamParams.base, b) - 1);
+        // SESAME_INFO("NOW Xi  "<<Xi);
+        return microCluster->weight < Xi;
+      });
       ds_timer.Tock();
 
       this->lastUpdateTime = this->pointArrivingTime;
@@ -134,15 +140,18 @@ void SESAME::DenStream::RunOnline(PointPtr in) {
 
 void SESAME::DenStream::merge(PointPtr dataPoint) {
   bool index = false;
+  // Micro clusters decay lazily, when they absorb a point
+  double decayFactor =
+      this->dampedWindow->decayFunction(lastPointTime, pointArrivingTime);
   if (!this->pMicroClusters.empty()) {
-    index = mergeToMicroCluster(dataPoint, this->pMicroClusters);
+    index = mergeToMicroCluster(dataPoint, decayFactor);
     //  std::cout<<"Merge into PMC! "<<pMicroClusters.size()<<","<<
     //  index<<","<<std::endl;
   }
 
   if (!index && !this->oMicroClusters.empty()) {
     // Time measurement inside the mergeToOMicroCluster function
-    index = mergeToOMicroCluster(dataPoint, this->oMicroClusters);
+    index = mergeToOMicroCluster(dataPoint, decayFactor);
     // std::cout<<"Merge into OMC! "<<oMicroClusters.size()<<","<<
     // index<<","<<std::endl;
   }
@@ -153,38 +162,39 @@ void SESAME::DenStream::merge(PointPtr dataPoint) {
     MicroClusterPtr newOMicroCluster = DataStructureFactory::createMicroCluster(
         denStreamParams.dim, oMicroClusterIndex);
     newOMicroCluster->Init(dataPoint, 0);
-    oMicroClusters.push_back(newOMicroCluster);
+    oMicroClusters.add(newOMicroCluster);
   }
   out_timer.Tock();
 }
 
-bool SESAME::DenStream::mergeToMicroCluster(
-    PointPtr dataPoint, std::vector<MicroClusterPtr> microClusters) {
+bool SESAME::DenStream::mergeToMicroCluster(PointPtr dataPoint,
+                                            double decayFactor) {
   ds_timer.Tick();
   bool index = false;
-  MicroClusterPtr MC = nearestNeighbor(dataPoint, microClusters);
+  size_t nearest = pMicroClusters.nearest(dataPoint);
   ds_timer.Tock();
   win_timer.Tick();
-  double decayFactor =
-      this->dampedWindow->decayFunction(lastPointTime, pointArrivingTime);
-  if (MC != NULL &&
-      MC->insert(dataPoint, decayFactor, denStreamParams.epsilon)) {
+  if (nearest < pMicroClusters.size() &&
+      pMicroClusters.at(nearest)->insert(dataPoint, decayFactor,
+                                         denStreamParams.epsilon)) {
+    pMicroClusters.syncCentroid(nearest);
     index = true;
   }
   win_timer.Tock();
   return index;
 }
 
-bool SESAME::DenStream::mergeToOMicroCluster(
-    PointPtr dataPoint, std::vector<MicroClusterPtr> microClusters) {
+bool SESAME::DenStream::mergeToOMicroCluster(PointPtr dataPoint,
+                                             double decayFactor) {
   out_timer.Tick();
-  MicroClusterPtr MC = nearestNeighbor(dataPoint, microClusters);
+  size_t nearest = oMicroClusters.nearest(dataPoint);
   out_timer.Tock();
   win_timer.Tick();
-  double decayFactor =
-      this->dampedWindow->decayFunction(lastPointTime, pointArrivingTime);
-  if (MC != NULL &&
-      MC->insert(dataPoint, decayFactor, denStreamParams.epsilon)) {
+  if (nearest < oMicroClusters.size() &&
+      oMicroClusters.at(nearest)->insert(dataPoint, decayFactor,
+                                         denStreamParams.epsilon)) {
+    MicroClusterPtr MC = oMicroClusters.at(nearest);
+    oMicroClusters.syncCentroid(nearest);
     double decayValue = this->dampedWindow->decayFunction(MC->lastUpdateTime,
                                                           pointArrivingTime);
     win_timer.Tock();
@@ -192,10 +202,8 @@ bool SESAME::DenStream::mergeToOMicroCluster(
     if (MC->weight * decayValue > minWeight) {
       pMicroClusterIndex++;
       MC->resetID(pMicroClusterIndex);
-      pMicroClusters.push_back(MC);
-      int index = findIndex(oMicroClusters, MC);
-      oMicroClusters.erase(oMicroClusters.begin() + index);
-      // std::remove(oMicroClusters.begin(), oMicroClusters.end(), MC);
+      pMicroClusters.add(MC);
+      oMicroClusters.remove(nearest);
     }
     ds_timer.Tock();
     return true;
@@ -204,41 +212,17 @@ bool SESAME::DenStream::mergeToOMicroCluster(
     return false;
   }
 }
-int SESAME::DenStream::findIndex(std::vector<MicroClusterPtr> &microClusters,
-                                 MicroClusterPtr MC) {
-  auto ret = std::find(microClusters.begin(), microClusters.end(), MC);
-  if (ret != microClusters.end())
-    return ret - microClusters.begin();
-  return -1;
-}
-
-SESAME::MicroClusterPtr
-SESAME::DenStream::nearestNeighbor(PointPtr dataPoint,
-                                   std::vector<MicroClusterPtr> microClusters) {
-  MicroClusterPtr targetMC = NULL;
-  double dist = 0, minDist = std::numeric_limits<double>::max();
-  for (vector<MicroClusterPtr>::size_type i = 0; i < microClusters.size();
-       i++) {
-    dist = microClusters.at(i)->calCentroidDistance(dataPoint);
-    if (dist < minDist) {
-      minDist = dist;
-      targetMC = microClusters.at(i);
-    }
-  }
-
-  return targetMC;
-}
 
 void SESAME::DenStream::RunOffline(DataSinkPtr sinkPtr) {
   on_timer.Add(sum_timer.start);
   ref_timer.Tick();
   vector<PointPtr> transformedPoints;
   std::vector<std::vector<PointPtr>> oldGroups;
-  microClusterToPoint(pMicroClusters, transformedPoints);
+  microClusterToPoint(pMicroClusters.microClusters, transformedPoints);
   this->dbscan->run(transformedPoints);
   this->dbscan->produceResult(transformedPoints, sinkPtr);
-  for (auto out = this->oMicroClusters.begin();
-       out != this->oMicroClusters.end(); ++out) {
+  for (auto out = this->oMicroClusters.microClusters.begin();
+       out != this->oMicroClusters.microClusters.end(); ++out) {
     PointPtr center = out->get()->getCenter();
     center->setClusteringCenter(-1);
     center->setOutlier(true);
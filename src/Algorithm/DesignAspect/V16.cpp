@@ -34,6 +34,9 @@ void SESAME::V16::OutputOnline(std::vector<PointPtr> &output) {
     output.push_back(point);
   }
   for (auto iter = 0; iter != this->clusterList.size(); iter++) {
+    // Emptied clusters are only dropped at the next adjustment
+    if (this->clusterList.at(iter).grids.empty())
+      continue;
     PointPtr point = GenericFactory::New<Point>(param.dim, iter);
     auto count = 0;
     for (auto &iterGrid : this->clusterList.at(iter).grids) {
@@ -48,8 +51,9 @@ void SESAME::V16::OutputOnline(std::vector<PointPtr> &output) {
                                 iterDim);
         }
       }
-      double weight = gridList.find(iterGrid.first)->second.gridDensity;
-      point->setWeight(point->getWeight() + weight);
+      auto grid = gridList.find(iterGrid.first);
+      if (grid != gridList.end())
+        point->setWeight(point->getWeight() + grid->second.gridDensity);
       count++;
     }
     point->setClusteringCenter(cluID++);
@@ -82,9 +86,6 @@ void SESAME::V16::RunOnline(PointPtr input) {
     removeSporadic();
     adjustClustering();
   }
-  if (windowGrid.size() == param.sliding + 1) {
-    RemoveWindowPointFromGrid();
-  }
   ds_timer.Tock();
   lat_timer.Add(input->toa);
 }
@@ -98,6 +99,9 @@ void SESAME::V16::RunOffline(DataSinkPtr sinkPtr) {
     sinkPtr->put(point);
   }
   for (auto iter = 0; iter != this->clusterList.size(); iter++) {
+    // Emptied clusters are only dropped at the next adjustment
+    if (this->clusterList.at(iter).grids.empty())
+      continue;
     PointPtr point = GenericFactory::New<Point>(param.dim, iter);
     auto count = 0;
     for (auto &iterGrid : this->clusterList.at(iter).grids) {
@@ -112,8 +116,9 @@ void SESAME::V16::RunOffline(DataSinkPtr sinkPtr) {
                                 iterDim);
         }
       }
-      double weight = gridList.find(iterGrid.first)->second.gridDensity;
-      point->setWeight(point->getWeight() + weight);
+      auto grid = gridList.find(iterGrid.first);
+      if (grid != gridList.end())
+        point->setWeight(point->getWeight() + grid->second.gridDensity);
       count++;
     }
     point->setClusteringCenter(cluID++);
@@ -133,24 +138,142 @@ void SESAME::V16::GridListUpdate(const std::vector<int> &coordinate) {
   if (it == gridList.end()) {
     characteristicVec =
         CharacteristicVector(currentTimeStamp, 0, 1.0, -1, false, dl, dm);
-    this->gridList.insert(std::make_pair(grid, characteristicVec));
+    it = this->gridList.insert(std::make_pair(grid, characteristicVec)).first;
   }
   // 4. Update the characteristic vector of dg
   else {
     it->second.densityWithNew(currentTimeStamp, param.lambda);
     it->second.updateTime = currentTimeStamp;
   }
-  windowGrid.push_back(grid);
+  if (param.sliding <= 0)
+    return;
+  it->second.windowCount++;
+  if (windowGrid.size() < (size_t)param.sliding) {
+    windowGrid.push_back(std::move(grid));
+    return;
+  }
+  // The window is full: the new point expires the oldest one and takes over
+  // its slot in the ring buffer
+  RemoveWindowPointFromGrid();
+  windowGrid[windowHead] = std::move(grid);
+  windowHead = (windowHead + 1) % windowGrid.size();
 }
 
-/* Update the grid list of V16 when data inserting into the grid
+/* Remove the oldest point of the sliding window from its grid, and the grid
+ * itself from grid_list and its cluster once no point of the window falls
+ * into it
  * */
 void SESAME::V16::RemoveWindowPointFromGrid() {
-  auto grid = windowGrid[0];
+  const DensityGrid &grid = windowGrid[windowHead];
   auto it = this->gridList.find(grid);
-  if (it != gridList.end()) {
-    it->second.gridDensity -= 1.0;
+  if (it == gridList.end())
+    return;
+  it->second.gridDensity -= 1.0;
+  if (--it->second.windowCount > 0)
+    return;
+  int label = it->second.label;
+  this->gridList.erase(it);
+  removeGridFromClusters(grid, label);
+}
+
+/**
+ * Remove a grid that left grid_list from the cluster its label names, and
+ * mark that cluster dirty. Dropping or splitting the cluster is left to
+ * splitDirtyClusters at the next adjustment, so an eviction stays O(1)
+ */
+void SESAME::V16::removeGridFromClusters(const DensityGrid &grid, int label) {
+  if (label < 0 || label >= (int)this->clusterList.size())
+    return;
+  if (this->clusterList[label].grids.erase(grid))
+    this->dirtyClusters.push_back(label);
+}
+
+/**
+ * Bring the clusters back in line with grid_list after grids left it. Grids
+ * no longer in grid_list are removed from every cluster, since the adjust
+ * paths can leave a grid in more than one. A cluster left empty is dropped,
+ * and one that no longer forms a grid group is split into its grid groups
+ * (Definition 3.4 of Chen and Tu 2007). The clusters are then relabelled by
+ * their index in cluster_list
+ */
+void SESAME::V16::splitDirtyClusters() {
+  std::vector<bool> dirty(this->clusterList.size(), false);
+  for (int label : this->dirtyClusters)
+    dirty[label] = true;
+  this->dirtyClusters.clear();
+  bool changed = false;
+  std::vector<GridCluster> split;
+  for (size_t index = this->clusterList.size(); index-- > 0;) {
+    GridCluster &cluster = this->clusterList[index];
+    for (auto entry = cluster.grids.begin(); entry != cluster.grids.end();) {
+      if (this->gridList.count(entry->first)) {
+        ++entry;
+        continue;
+      }
+      entry = cluster.grids.erase(entry);
+      dirty[index] = true;
+    }
+    if (!dirty[index])
+      continue;
+    if (cluster.grids.empty()) {
+      this->clusterList.erase(this->clusterList.begin() + index);
+      changed = true;
+      continue;
+    }
+    std::vector<GridCluster> groups = gridGroups(cluster);
+    if (groups.size() > 1)
+      changed = true;
+    cluster = std::move(groups[0]);
+    for (size_t group = 1; group < groups.size(); group++)
+      split.push_back(std::move(groups[group]));
+  }
+  for (auto &cluster : split)
+    this->clusterList.push_back(std::move(cluster));
+  if (!changed)
+    return;
+  for (size_t index = 0; index < this->clusterList.size(); index++) {
+    GridCluster &cluster = this->clusterList[index];
+    cluster.clusterLabel = (int)index;
+    for (auto &entry : cluster.grids) {
+      auto it = this->gridList.find(entry.first);
+      if (it != this->gridList.end())
+        it->second.label = (int)index;
+    }
+  }
+}
+
+/**
+ * @return the grid groups of the cluster, i.e. its maximal sets of grids
+ * connected through neighbouring grids, with their inside flags recomputed
+ */
+std::vector<SESAME::GridCluster>
+SESAME::V16::gridGroups(const GridCluster &cluster) {
+  std::vector<GridCluster> groups;
+  HashGrids seen;
+  std::vector<DensityGrid> stack;
+  DensityGrid probe;
+  for (auto &start : cluster.grids) {
+    if (!seen.emplace(start.first, true).second)
+      continue;
+    GridCluster group(cluster.clusterLabel);
+    stack.push_back(start.first);
+    while (!stack.empty()) {
+      DensityGrid current = std::move(stack.back());
+      stack.pop_back();
+      current.forEachNeighbour(probe, [&](const DensityGrid &neighbour) {
+        if (cluster.grids.count(neighbour) &&
+            seen.emplace(neighbour, true).second)
+          stack.push_back(neighbour);
+        return false;
+      });
+      group.grids.emplace(std::move(current), false);
+    }
+    groups.push_back(std::move(group));
   }
+  for (auto &group : groups)
+    for (auto &entry : group.grids)
+      entry.second = group.isInside(entry.first);
+  return groups;
 }
 
 /**
@@ -163,104 +286,13 @@ void SESAME::V16::initialClustering() {
   // 2. Assign each dense grid to a distinct cluster
   // and
   // 3. Label all other grids as NO_CLASS
-  auto gridIter = this->gridList.begin();
-  HashMap newGridList;
-  while (gridIter != gridList.end()) {
-    DensityGrid grid = gridIter->first;
-    CharacteristicVector characteristicVecOfG = gridIter->second;
-    if (characteristicVecOfG.attribute == DENSE) {
-      int gridClass = this->clusterList.size();
-      characteristicVecOfG.label = gridClass;
-      GridCluster gridCluster = GridCluster(gridClass);
-      gridCluster.addGrid(grid);
-      this->clusterList.push_back(gridCluster);
-      //  // SESAME_INFO(" was dense (class "<<gridClass<<")" <<"Position is "<<
-      //  this->clusterList.size());
-    } else
-      characteristicVecOfG.label = NO_CLASS;
-    newGridList.insert(std::make_pair(grid, characteristicVecOfG));
-    ++gridIter;
-  }
-  this->gridList = newGridList;
-  // 4. Make changes to grid labels by doing:
-  //    a. For each cluster c
-  //    b. For each outside grid g of c
-  //    c. For each neighbouring grid h of g
-  //    d. If h belongs to c', label c and c' with
-  //       the label of the largest cluster
-  //    e. Else if h is transitional, assign it to c
-  //    f. While changes can be made
-  while (adjustLabels())
-    ; // while changes are being made
-}
-/**
- * Makes first change available to it by following the steps:
- * For each cluster c<
- * For each outside grid g of c
- * For each neighbouring grid h of g
- * If h belongs to c', label c and c' with the label of the largest cluster
- * Else if h is transitional, assign it to c
- * @return TRUE if a change was made to any cluster's labels, FALSE otherwise
- */
-bool SESAME::V16::adjustLabels() {
-  // bool adjust=false;
-  // a. For each cluster c
-  for (GridCluster &gridCluster : this->clusterList) {
-    // // SESAME_INFO("Adjusting from cluster "<<gridCluster.clusterLabel<<",
-    // standby..."); b. for each grid, dg, of c
-    for (auto gridIter = gridCluster.grids.begin();
-         gridIter != gridCluster.grids.end(); gridIter++) {
-      {
-        const DensityGrid &grid = gridIter->first;
-        bool inside = gridIter->second;
-        // // SESAME_INFO(" Inspecting density grid, grid, standby...");
-
-        // b. for each OUTSIDE grid of cluster
-        if (!inside) {
-          //  // SESAME_INFO(" Density grid dg is outside!");
-          // c. for each neighbouring grid, of current iter grid
-          for (const DensityGrid &gridNeighbourhood : grid.getNeighbours()) {
-            auto it2 = this->gridList.find(gridNeighbourhood);
-            if (it2 != gridList.end()) {
-              auto it1 = this->gridList.find(grid);
-              CharacteristicVector characteristicVec1 = it1->second;
-              CharacteristicVector characteristicVec2 = it2->second;
-              int class1 = characteristicVec1.label;
-              int class2 = characteristicVec2.label;
-              // ...and if neighbouring grid isn't already in the same cluster
-              // as grid...
-              if (class1 != class2) {
-                // If neighbouring grid is in cluster c', merge c and c' into
-                // the larger of the two
-                if (class2 != NO_CLASS) {
-                  if (this->clusterList.at(class1).grids.size() <
-                      this->clusterList.at(class2).grids.size())
-                    mergeClusters(class1, class2);
-                  else
-                    mergeClusters(class2, class1);
-                  return true;
-                }
-                // If gridNeighbourhood is transitional and 'outside' of the
-                // cluster, assign it to cluster
-                else if (characteristicVec2.isTransitional(dm, dl)) {
-                  characteristicVec2.label = class1;
-                  gridCluster.addGrid(gridNeighbourhood);
-                  this->clusterList.at(class1) = gridCluster;
-                  if (it1 != gridList.end())
-                    it1->second = characteristicVec2;
-                  else
-                    this->gridList.insert(
-                        std::make_pair(grid, characteristicVec2));
-                  return true;
-                }
-              }
-            }
-          }
-        }
-      }
-    }
-  }
-  return false;
+  // and
+  // 4. Make changes to grid labels until no more changes can be made, i.e.
+  //    merge clusters of neighbouring grids and absorb neighbouring
+  //    transitional grids. This converges to the connected components of the
+  //    dense and transitional grids, which are found in one parallel pass.
+  this->clusterList = GridCluster::connectedClusters(this->gridList);
+  this->dirtyClusters.clear();
 }
 
 /**
@@ -283,12 +315,22 @@ void SESAME::V16::updateGridListDensity() {
  */
 void SESAME::V16::adjustClustering() {
   // SESAME_INFO("ADJUST CLUSTERING CALLED ");
+  splitDirtyClusters();
   // 1. Update the density of all grids in grid_list
   updateGridListDensity();
   // 2. For each grid dg whose attribute is changed since last call
   //    a. If dg is sparse
   //    b. If dg is dense
   //    c. If dg is transitional
+  size_t changed = std::count_if(
+      gridList.begin(), gridList.end(),
+      [](const auto &iter) { return iter.second.attChange; });
+  // Relabelling all grids in parallel is cheaper than adjusting many changed
+  // grids one after another
+  if (changed > GridCluster::RELABEL_RATIO * gridList.size()) {
+    this->clusterList = GridCluster::connectedClusters(this->gridList);
+    return;
+  }
   while (inspectChangedGrids())
     ;
 }
@@ -430,8 +472,8 @@ SESAME::V16::adjustNewLabels(const SESAME::HashMap &newGridList) {
       // b. for each OUTSIDE grid, dg, of c
       if (!inside) {
         // c. for each neighbouring grid, neighbourGrid, of dg
-
-        for (DensityGrid &neighbourGrid : grid.getNeighbours()) {
+        grid.getNeighbours(neighbours);
+        for (DensityGrid &neighbourGrid : neighbours) {
           if (newGridList.find(neighbourGrid) != newGridList.end()) {
             CharacteristicVector characteristicVec1 =
                 newGridList.find(neighbourGrid)->second;
@@ -502,8 +544,9 @@ SESAME::V16::adjustForDenseGrid(const DensityGrid &grid,
 
   HashMap newGridList;
   //// SESAME_INFO("adjust For Dense Grid "<<gridClass<<".");
+  grid.getNeighbours(neighbours);
   for (DensityGrid &neighbourGrid :
-       grid.getNeighbours()) // The neighbour of g being considered
+       neighbours) // The neighbour of g being considered
   {
     if (this->gridList.find(neighbourGrid) != gridList.end()) {
       hClass = this->gridList.find(neighbourGrid)->second.label;
@@ -598,7 +641,8 @@ SESAME::V16::adjustForDenseGrid(const DensityGrid &grid,
     // Iterate through the neighbourhood until no more transitional neighbours
     // can be added (dense neighbours will add themselves as part of their
     // adjust process)
-    for (DensityGrid &dghprime : grid.getNeighbours()) {
+    grid.getNeighbours(neighbours);
+    for (DensityGrid &dghprime : neighbours) {
       if (this->gridList.find(dghprime) != this->gridList.end() &&
           c.grids.find(dghprime) != c.grids.end()) {
         CharacteristicVector cvhprime = this->gridList.find(dghprime)->second;
@@ -639,7 +683,8 @@ SESAME::V16::adjustForTransitionalGrid(const DensityGrid &grid,
   int hChosenClass = NO_CLASS; // The class label of ch
   HashMap newGridList;
   //// SESAME_INFO("adjust For Transitional Grid "<<gridClass<<".");
-  for (DensityGrid &neighbourGrid : grid.getNeighbours()) {
+  grid.getNeighbours(neighbours);
+  for (DensityGrid &neighbourGrid : neighbours) {
     auto it = this->gridList.find(neighbourGrid);
     if (it != gridList.end()) {
       hClass = it->second.label;
@@ -852,8 +897,11 @@ void SESAME::V16::removeSporadic() {
     CharacteristicVector characteristicVec = gridIter.second;
     // If g is sporadic
     if (characteristicVec.isSporadic) {
-      // If currTime - tg > gap, delete g from grid_list
-      if (currentTimeStamp - characteristicVec.updateTime >= gap) {
+      // If currTime - tg > gap, delete g from grid_list. Grids still holding
+      // points of the sliding window are dropped when their last point
+      // expires instead.
+      if (currentTimeStamp - characteristicVec.updateTime >= gap &&
+          characteristicVec.windowCount == 0) {
         int gridClass = characteristicVec.label;
 
         if (gridClass != -1) {
@@ -157,104 +157,12 @@ void SESAME::V9::initialClustering() {
   // 2. Assign each dense grid to a distinct cluster
   // and
   // 3. Label all other grids as NO_CLASS
-  auto gridIter = this->gridList.begin();
-  HashMap newGridList;
-  while (gridIter != gridList.end()) {
-    DensityGrid grid = gridIter->first;
-    CharacteristicVector characteristicVecOfG = gridIter->second;
-    if (characteristicVecOfG.attribute == DENSE) {
-      int gridClass = this->clusterList.size();
-      characteristicVecOfG.label = gridClass;
-      GridCluster gridCluster = GridCluster(gridClass);
-      gridCluster.addGrid(grid);
-      this->clusterList.push_back(gridCluster);
-      //  // SESAME_INFO(" was dense (class "<<gridClass<<")" <<"Position is "<<
-      //  this->clusterList.size());
-    } else
-      characteristicVecOfG.label = NO_CLASS;
-    newGridList.insert(std::make_pair(grid, characteristicVecOfG));
-    ++gridIter;
-  }
-  this->gridList = newGridList;
-  // 4. Make changes to grid labels by doing:
-  //    a. For each cluster c
-  //    b. For each outside grid g of c
-  //    c. For each neighbouring grid h of g
-  //    d. If h belongs to c', label c and c' with
-  //       the label of the largest cluster
-  //    e. Else if h is transitional, assign it to c
-  //    f. While changes can be made
-  while (adjustLabels())
-    ; // while changes are being made
-}
-/**
- * Makes first change available to it by following the steps:
- * For each cluster c<
- * For each outside grid g of c
- * For each neighbouring grid h of g
- * If h belongs to c', label c and c' with the label of the largest cluster
- * Else if h is transitional, assign it to c
- * @return TRUE if a change was made to any cluster's labels, FALSE otherwise
- */
-bool SESAME::V9::adjustLabels() {
-  // bool adjust=false;
-  // a. For each cluster c
-  for (GridCluster &gridCluster : this->clusterList) {
-    // // SESAME_INFO("Adjusting from cluster "<<gridCluster.clusterLabel<<",
-    // standby..."); b. for each grid, dg, of c
-    for (auto gridIter = gridCluster.grids.begin();
-         gridIter != gridCluster.grids.end(); gridIter++) {
-      {
-        const DensityGrid &grid = gridIter->first;
-        bool inside = gridIter->second;
-        // // SESAME_INFO(" Inspecting density grid, grid, standby...");
-
-        // b. for each OUTSIDE grid of cluster
-        if (!inside) {
-          //  // SESAME_INFO(" Density grid dg is outside!");
-          // c. for each neighbouring grid, of current iter grid
-          for (const DensityGrid &gridNeighbourhood : grid.getNeighbours()) {
-            auto it2 = this->gridList.find(gridNeighbourhood);
-            if (it2 != gridList.end()) {
-              auto it1 = this->gridList.find(grid);
-              CharacteristicVector characteristicVec1 = it1->second;
-              CharacteristicVector characteristicVec2 = it2->second;
-              int class1 = characteristicVec1.label;
-              int class2 = characteristicVec2.label;
-              // ...and if neighbouring grid isn't already in the same cluster
-              // as grid...
-              if (class1 != class2) {
-                // If neighbouring grid is in cluster c', merge c and c' into
-                // the larger of the two
-                if (class2 != NO_CLASS) {
-                  if (this->clusterList.at(class1).grids.size() <
-                      this->clusterList.at(class2).grids.size())
-                    mergeClusters(class1, class2);
-                  else
-                    mergeClusters(class2, class1);
-                  return true;
-                }
-                // If gridNeighbourhood is transitional and 'outside' of the
-                // cluster, assign it to cluster
-                else if (characteristicVec2.isTransitional(dm, dl)) {
-                  characteristicVec2.label = class1;
-                  gridCluster.addGrid(gridNeighbourhood);
-                  this->clusterList.at(class1) = gridCluster;
-                  if (it1 != gridList.end())
-                    it1->second = characteristicVec2;
-                  else
-                    this->gridList.insert(
-                        std::make_pair(grid, characteristicVec2));
-                  return true;
-                }
-              }
-            }
-          }
-        }
-      }
-    }
-  }
-  return false;
+  // and
+  // 4. Make changes to grid labels until no more changes can be made, i.e.
+  //    merge clusters of neighbouring grids and absorb neighbouring
+  //    transitional grids. This converges to the connected components of the
+  //    dense and transitional grids, which are found in one parallel pass.
+  this->clusterList = GridCluster::connectedClusters(this->gridList);
 }
 
 /**
@@ -283,6 +191,15 @@ void SESAME::V9::adjustClustering() {
   //    a. If dg is sparse
   //    b. If dg is dense
   //    c. If dg is transitional
+  size_t changed = std::count_if(
+      gridList.begin(), gridList.end(),
+      [](const auto &iter) { return iter.second.attChange; });
+  // Relabelling all grids in parallel is cheaper than adjusting many changed
+  // grids one after another
+  if (changed > GridCluster::RELABEL_RATIO * gridList.size()) {
+    this->clusterList = GridCluster::connectedClusters(this->gridList);
+    return;
+  }
   while (inspectChangedGrids())
     ;
 }
@@ -424,8 +341,8 @@ SESAME::V9::adjustNewLabels(const SESAME::HashMap &newGridList) {
       // b. for each OUTSIDE grid, dg, of c
       if (!inside) {
         // c. for each neighbouring grid, neighbourGrid, of dg
-
-        for (DensityGrid &neighbourGrid : grid.getNeighbours()) {
+        grid.getNeighbours(neighbours);
+        for (DensityGrid &neighbourGrid : neighbours) {
           if (newGridList.find(neighbourGrid) != newGridList.end()) {
             CharacteristicVector characteristicVec1 =
                 newGridList.find(neighbourGrid)->second;
@@ -496,8 +413,9 @@ SESAME::V9::adjustForDenseGrid(const DensityGrid &grid,
 
   HashMap newGridList;
   //// SESAME_INFO("adjust For Dense Grid "<<gridClass<<".");
+  grid.getNeighbours(neighbours);
   for (DensityGrid &neighbourGrid :
-       grid.getNeighbours()) // The neighbour of g being considered
+       neighbours) // The neighbour of g being considered
   {
     if (this->gridList.find(neighbourGrid) != gridList.end()) {
       hClass = this->gridList.find(neighbourGrid)->second.label;
@@ -592,7 +510,8 @@ SESAME::V9::adjustForDenseGrid(const DensityGrid &grid,
     // Iterate through the neighbourhood until no more transitional neighbours
     // can be added (dense neighbours will add themselves as part of their
     // adjust process)
-    for (DensityGrid &dghprime : grid.getNeighbours()) {
+    grid.getNeighbours(neighbours);
+    for (DensityGrid &dghprime : neighbours) {
       if (this->gridList.find(dghprime) != this->gridList.end() &&
           c.grids.find(dghprime) != c.grids.end()) {
         CharacteristicVector cvhprime = this->gridList.find(dghprime)->second;
@@ -633,7 +552,8 @@ SESAME::V9::adjustForTransitionalGrid(const DensityGrid &grid,
   int hChosenClass = NO_CLASS; // The class label of ch
   HashMap newGridList;
   //// SESAME_INFO("adjust For Transitional Grid "<<gridClass<<".");
-  for (DensityGrid &neighbourGrid : grid.getNeighbours()) {
+  grid.getNeighbours(neighbours);
+  for (DensityGrid &neighbourGrid : neighbours) {
     auto it = this->gridList.find(neighbourGrid);
     if (it != gridList.end()) {
       hClass = it->second.label;
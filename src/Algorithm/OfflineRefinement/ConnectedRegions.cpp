@@ -3,6 +3,7 @@
 //
 
 #include <Algorithm/OfflineRefinement/ConnectedRegions.hpp>
+#include <numeric>
 SESAME::ConnectedRegions::ConnectedRegions() {}
 SESAME::ConnectedRegions::ConnectedRegions(double alpha, double min_weight) {
   this->alpha = alpha;
@@ -12,108 +13,88 @@ void SESAME::ConnectedRegions::connection(
     std::vector<MicroClusterPtr> &microClusters,
 
     SESAME::WeightedAdjacencyList &weightedAdjacencyList) {
-  WeightedAdjacencyList::iterator iterW;
-  for (iterW = weightedAdjacencyList.begin();
-       iterW != weightedAdjacencyList.end(); iterW++) {
-    //  std::cout<<" cluster 1 weight "<<iterW->first.microCluster1->weight
-    //  <<", cluster 2 weight "<<iterW->first.microCluster2->weight<<"weight min
-    //  is
-    //  "<<min_weight<<std::endl;
-    if (iterW->first.microCluster1->weight >= min_weight &&
-        iterW->first.microCluster2->weight >= min_weight) {
-      double val = 2 * iterW->second->weight /
-                   (iterW->first.microCluster1->weight +
-                    iterW->first.microCluster2->weight);
-      if (val > min_weight) {
-        insertIntoGraph(microClusters, iterW->first.microCluster1->id.front(),
-                        iterW->first.microCluster2->id.front());
+  rebuild(microClusters, weightedAdjacencyList);
+  findConnectedComponents();
+}
 
-        insertIntoGraph(microClusters, iterW->first.microCluster2->id.front(),
-                        iterW->first.microCluster1->id.front());
-      } else {
-        insertIntoGraph(microClusters, iterW->first.microCluster1->id.front());
-        insertIntoGraph(microClusters, iterW->first.microCluster2->id.front());
-      }
-    }
-  }
-  findConnectedComponents(microClusters);
+void SESAME::ConnectedRegions::rebuild(
+    const std::vector<MicroClusterPtr> &microClusters,
+    SESAME::WeightedAdjacencyList &weightedAdjacencyList) {
+  // The graph keys pairs by micro cluster id only
+  int size = (int)microClusters.size();
+  vertices = microClusters;
+  slotOfId.clear();
+  slotOfId.reserve(size);
+  for (int slot = 0; slot < size; slot++)
+    slotOfId[microClusters[slot]->id.front()] = slot;
+  parent.resize(size);
+  std::iota(parent.begin(), parent.end(), 0);
+  inGraph.assign(size, false);
+  weightedAdjacencyList.forEach(
+      [&](int id1, int id2, AdjustedWeight &adjustedWeight) {
+        link(id1, id2, adjustedWeight.weight);
+      });
+}
+
+void SESAME::ConnectedRegions::addVertex(const MicroClusterPtr &microCluster) {
+  slotOfId[microCluster->id.front()] = (int)vertices.size();
+  parent.push_back((int)vertices.size());
+  inGraph.push_back(false);
+  vertices.push_back(microCluster);
 }
-/**
- * @Description:  insert vertices and entries into connectivity graph when micro
- * cluster pair connectivity value greater than the intersection threshold if
- * the graph has testing micro cluster, add connected strong MC in the
- * corresponding entries else, create new V,E into the graph
- * @Param: connectivity graph, micro cluster 1 and 2
- * @Return: void
- */
 
-void SESAME::ConnectedRegions::insertIntoGraph(
-    const std::vector<MicroClusterPtr> &microClusters, int microClusterId,
-    int OtherId) {
-  if (connecvtivityGraphId.find(microClusterId) != connecvtivityGraphId.end()) {
-    connecvtivityGraphId[microClusterId].push_back(OtherId);
-  } else {
-    auto microCluster = std::find_if(microClusters.begin(), microClusters.end(),
-                                     [&](const MicroClusterPtr &mc) {
-                                       return mc->id.front() == microClusterId;
-                                     });
-    (*microCluster)->visited = false;
-    std::vector<int> newMicroClusterIdSet;
-    newMicroClusterIdSet.push_back(OtherId);
-    connecvtivityGraphId.insert(make_pair(microClusterId, OtherId));
+void SESAME::ConnectedRegions::removeVertex(int id) {
+  auto iter = slotOfId.find(id);
+  if (iter == slotOfId.end())
+    return;
+  vertices[iter->second] = nullptr;
+  slotOfId.erase(iter);
+}
+
+void SESAME::ConnectedRegions::link(int id1, int id2, double weight) {
+  auto iter1 = slotOfId.find(id1);
+  auto iter2 = slotOfId.find(id2);
+  if (iter1 == slotOfId.end() || iter2 == slotOfId.end())
+    return;
+  const MicroClusterPtr &microCluster1 = vertices[iter1->second];
+  const MicroClusterPtr &microCluster2 = vertices[iter2->second];
+  if (microCluster1->weight >= min_weight &&
+      microCluster2->weight >= min_weight) {
+    inGraph[iter1->second] = inGraph[iter2->second] = true;
+    double val = 2 * weight / (microCluster1->weight + microCluster2->weight);
+    if (val > min_weight)
+      unite(iter1->second, iter2->second);
   }
 }
 
-void SESAME::ConnectedRegions::insertIntoGraph(
-    const std::vector<MicroClusterPtr> &microClusters, int microClusterId) {
-  if (connecvtivityGraphId.find(microClusterId) == connecvtivityGraphId.end()) {
-    // std::cerr << "INSERT micro cluster id is " << microClusterId <<
-    // std::endl;
-    auto microCluster = std::find_if(microClusters.begin(), microClusters.end(),
-                                     [&](const MicroClusterPtr &mc) {
-                                       return mc->id.front() == microClusterId;
-                                     });
-    (*microCluster)->visited = false;
-    std::vector<int> newMicroClusterIdSet;
-    connecvtivityGraphId.insert(
-        make_pair(microClusterId, newMicroClusterIdSet));
+int SESAME::ConnectedRegions::findRoot(int slot) {
+  while (parent[slot] != slot) {
+    parent[slot] = parent[parent[slot]];
+    slot = parent[slot];
   }
+  return slot;
 }
 
-void SESAME::ConnectedRegions::findConnectedComponents(
-    const std::vector<SESAME::MicroClusterPtr> &microClusters) {
-  unordered_map<int, std::vector<int>>::iterator iter;
-  // This variable just for indicating the id of micro cluster which forming
-  // macro clusters
-  for (iter = connecvtivityGraphId.begin(); iter != connecvtivityGraphId.end();
-       iter++) {
-    std::vector<int> idList;
-    auto microClusterKey =
-        std::find_if(microClusters.begin(), microClusters.end(),
-                     [&](const MicroClusterPtr &mc) {
-                       return mc->id.front() == iter->first;
-                     });
-    if (microClusterKey != microClusters.end() &&
-        !(*microClusterKey)->visited) {
-      std::vector<SESAME::MicroClusterPtr> newCluster;
-      newCluster.push_back((*microClusterKey));
-      idList.push_back(iter->first);
-      for (int iterValue : iter->second) {
-        auto microClusterElement =
-            std::find_if(microClusters.begin(), microClusters.end(),
-                         [&](const MicroClusterPtr &mc) {
-                           return mc->id.front() == iterValue;
-                         });
-        if (microClusterElement != microClusters.end()) {
-          if (!(*microClusterElement)->visited) {
-            newCluster.push_back((*microClusterElement));
-            (*microClusterElement)->visited = true;
-            idList.push_back((*microClusterElement)->id.front());
-          }
-        }
-      }
-      this->finalClusters.push_back(newCluster);
+void SESAME::ConnectedRegions::unite(int slot1, int slot2) {
+  int root1 = findRoot(slot1), root2 = findRoot(slot2);
+  // The smaller slot stays the root, so the forest does not depend on the
+  // order of the edges
+  if (root1 != root2)
+    parent[std::max(root1, root2)] = std::min(root1, root2);
+}
+
+void SESAME::ConnectedRegions::findConnectedComponents() {
+  finalClusters.clear();
+  std::vector<int> clusterOfRoot(vertices.size(), -1);
+  for (int slot = 0; slot < vertices.size(); slot++) {
+    if (vertices[slot] == nullptr || !inGraph[slot])
+      continue;
+    int root = findRoot(slot);
+    if (clusterOfRoot[root] < 0) {
+      clusterOfRoot[root] = (int)finalClusters.size();
+      finalClusters.emplace_back();
     }
+    finalClusters[clusterOfRoot[root]].push_back(vertices[slot]);
   }
 }
 
@@ -4,6 +4,8 @@
 #include "Algorithm/OfflineRefinement/DBSCAN.hpp"
 #include "Algorithm/Param.hpp"
 
+#include <numeric>
+
 SESAME::DBSCAN::DBSCAN(unsigned int minPts, float eps) {
   this->min_points = minPts;
   this->epsilon = eps;
@@ -19,53 +21,68 @@ SESAME::DBSCAN::DBSCAN() {
 }
 
 SESAME::DBSCAN::~DBSCAN() = default;
-void SESAME::DBSCAN::run(std::vector<PointPtr> &input) {
-  for (auto &i : input) {
-    i->setClusteringCenter(UNCLASSIFIED);
-  }
-  for (int i = 0; i < input.size(); i++) {
-    if (input[i]->getClusteringCenter() == UNCLASSIFIED) {
-      if (expandCluster(input, input[i], clusterID) != FAILURE) {
-        clusterID += 1;
-      }
-    }
-  }
-}
+void SESAME::DBSCAN::run(std::vector<PointPtr> &input) { cluster(input); }
 
 void SESAME::DBSCAN::Run(SesameParam &param, std::vector<PointPtr> &input,
                          SESAME::DataSinkPtr sinkPtr) {
   this->min_points = param.min_points;
   this->epsilon = param.epsilon;
   // this->pointSize = size;
+  this->clusterID = 0;
+  cluster(input);
+  produceResult(input, sinkPtr);
+}
+
+void SESAME::DBSCAN::cluster(std::vector<PointPtr> &input) {
   for (auto &i : input) {
     i->setClusteringCenter(UNCLASSIFIED);
   }
-  this->clusterID = 0;
+  int dim = input.empty() ? 0 : input.front()->getDimension();
+  if (dim <= PointGridIndex::GRID_DIMS) {
+    grid = std::make_shared<PointGridIndex>(input, epsilon);
+    tree.reset();
+  } else {
+    std::vector<int> members(input.size());
+    std::iota(members.begin(), members.end(), 0);
+    tree = std::make_shared<KdTree>(input, members);
+    grid.reset();
+  }
+  // A point is a core point if its region holds at least min_points points,
+  // only the regions of core points are expanded
+  std::vector<char> core(input.size());
+#pragma omp parallel
+  {
+    std::vector<int> neighbours;
+#pragma omp for schedule(dynamic, 64)
+    for (int i = 0; i < (int)input.size(); i++) {
+      regionQuery(input, i, neighbours);
+      core[i] = neighbours.size() >= min_points;
+    }
+  }
   for (int i = 0; i < input.size(); i++) {
     if (input[i]->getClusteringCenter() == UNCLASSIFIED) {
-      if (expandCluster(input, input[i], clusterID) != FAILURE) {
+      if (expandCluster(input, core, i, clusterID) != FAILURE) {
         clusterID += 1;
       }
     }
   }
-  produceResult(input, sinkPtr);
 }
 
-int SESAME::DBSCAN::expandCluster(std::vector<PointPtr> &input, PointPtr &point,
-                                  int clusterID) const {
-  std::vector<int> clusterSeeds = calculateCluster(input, point);
-  if (clusterSeeds.size() < min_points) {
-    point->setClusteringCenter(NOISE);
+int SESAME::DBSCAN::expandCluster(std::vector<PointPtr> &input,
+                                  const std::vector<char> &core, int point,
+                                  int clusterID) {
+  if (!core[point]) {
+    input[point]->setClusteringCenter(NOISE);
     return FAILURE;
   } else {
-    int index, indexCorePoint = 0;
+    regionQuery(input, point, clusterSeeds);
+    int seed, indexCorePoint = 0;
     for (int iterSeeds = 0; iterSeeds < clusterSeeds.size(); iterSeeds++) {
-      index = clusterSeeds.at(iterSeeds);
+      seed = clusterSeeds.at(iterSeeds);
 
-      input.at(index)->setClusteringCenter(clusterID);
-      if (judgeCorePoint(
-              input.at(index),
-              point)) // check if the seed point in input is the core point?
+      input.at(seed)->setClusteringCenter(clusterID);
+      // check if the seed point in input is the core point?
+      if (judgeCorePoint(input.at(seed), input.at(point)))
         indexCorePoint = iterSeeds;
     }
     clusterSeeds.erase(clusterSeeds.begin() + indexCorePoint);
@@ -73,20 +90,19 @@ int SESAME::DBSCAN::expandCluster(std::vector<PointPtr> &input, PointPtr &point,
     for (std::vector<int>::size_type i = 0, currentSize = clusterSeeds.size();
          i < currentSize; i++) // ++i or i++?
     {
-      std::vector<int> clusterNeighbors =
-          calculateCluster(input, input.at(clusterSeeds[i]));
-      if (clusterNeighbors.size() >= min_points) {
-        for (std::vector<int>::size_type iterNeighbors = 0;
-             iterNeighbors < clusterNeighbors.size(); iterNeighbors++) {
-          index = clusterNeighbors.at(iterNeighbors);
-          if (input.at(index)->getClusteringCenter() == UNCLASSIFIED ||
-              input.at(index)->getClusteringCenter() == NOISE) {
-            if (input.at(index)->getClusteringCenter() == UNCLASSIFIED) {
-              clusterSeeds.push_back(index);
-              currentSize = clusterSeeds.size();
-            }
-            input.at(index)->setClusteringCenter(clusterID);
+      if (!core[clusterSeeds[i]])
+        continue;
+      regionQuery(input, clusterSeeds[i], clusterNeighbors);
+      for (std::vector<int>::size_type iterNeighbors = 0;
+           iterNeighbors < clusterNeighbors.size(); iterNeighbors++) {
+        seed = clusterNeighbors.at(iterNeighbors);
+        if (input.at(seed)->getClusteringCenter() == UNCLASSIFIED ||
+            input.at(seed)->getClusteringCenter() == NOISE) {
+          if (input.at(seed)->getClusteringCenter() == UNCLASSIFIED) {
+            clusterSeeds.push_back(seed);
+            currentSize = clusterSeeds.size();
           }
+          input.at(seed)->setClusteringCenter(clusterID);
         }
       }
     }
@@ -94,23 +110,12 @@ int SESAME::DBSCAN::expandCluster(std::vector<PointPtr> &input, PointPtr &point,
   }
 }
 
-std::vector<int> SESAME::DBSCAN::calculateCluster(std::vector<PointPtr> &input,
-                                                  PointPtr &point) const {
-  std::vector<int> clusterIndex;
-  for (int i = 0; i < input.size(); i++) {
-    if (calculateEluDistance(point, input[i]) <= epsilon)
-      clusterIndex.push_back(i);
-  }
-  return clusterIndex;
-}
-
-double SESAME::DBSCAN::calculateEluDistance(PointPtr &point, PointPtr &center) {
-  double dist = 0;
-  for (int i = 0; i < point->getDimension(); i++) {
-    dist += pow(point->getFeatureItem(i) - center->getFeatureItem(i), 2);
-  }
-  dist = sqrt(dist);
-  return dist;
+void SESAME::DBSCAN::regionQuery(std::vector<PointPtr> &input, int point,
+                                 std::vector<int> &neighbours) const {
+  if (grid)
+    grid->rangeQuery(point, neighbours);
+  else
+    tree->rangeQuery(input[point], epsilon, neighbours);
 }
 
 bool SESAME::DBSCAN::judgeCorePoint(PointPtr &point, PointPtr &other) {
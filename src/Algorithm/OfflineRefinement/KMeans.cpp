@@ -6,9 +6,12 @@
 //
 
 #include <Algorithm/DataStructure/DataStructureFactory.hpp>
+#include <Algorithm/DataStructure/KMeansPPSeeder.hpp>
+#include <Algorithm/DataStructure/PointMatrix.hpp>
 #include <Algorithm/OfflineRefinement/KMeans.hpp>
 #include <Algorithm/Param.hpp>
 #include <Utils/Logger.hpp>
+#include <limits>
 
 /**
  * @Description: First step: select k elements randomly in input as initial
@@ -59,166 +62,219 @@ void SESAME::KMeans::selectCentersFromWeight(int numberOfCenters,
                                              int numberOfInput,
                                              std::vector<PointPtr> &input,
                                              std::vector<PointPtr> &centers) {
-  std::vector<int> indexs; // for unique
-  indexs.push_back(centers.at(0)->getIndex());
-  // cout << "KMeans++ randomly select indexes: ";
-  int times = 0;
-  while (times < numberOfCenters) {
-    double sum = 0;
-    vector<PointPtr> leftOver;
-    std::vector<double> weightSquare, probability;
-    for (int i = 0; i < numberOfInput; i++) {
-      if (count(indexs.begin(), indexs.end(), input.at(i)->getIndex()) == 0) {
-        leftOver.push_back(input.at(i)->copy());
-        double Min = calculateEluDistance(input.at(i), centers.at(0));
-        // Min is D(x)
-        for (int j = 1; j < centers.size(); j++) {
-          if (Min > calculateEluDistance(input.at(i), centers.at(j))) {
-            Min = calculateEluDistance(input.at(i), centers.at(j));
-          }
-        }
-        weightSquare.push_back(pow(Min, 2));
-        sum += pow(Min, 2);
-        // here we only need to store D2.txt(x)
-      }
-    }
-
-    // calculate the weight of every other point(except centers)
-    for (double i : weightSquare) {
-      probability.push_back(i / sum);
-    }
-
-    double left = 0, right = 0;
+  KMeansPPSeeder seeder(input);
+  for (auto &center : centers)
+    seeder.addCentre(center);
+  for (int times = 0; times < numberOfCenters; times++) {
+    if (seeder.exhausted())
+      break;
     double r = ((double)rand() / (RAND_MAX));
-    for (int i = 0; i < leftOver.size(); i++) {
-      right += probability.at(i);
-      if (r > left && r <= right) {
-        // cout << "randomly generate number: " << u(e) << endl;
-        if (count(indexs.begin(), indexs.end(), leftOver.at(i)->getIndex()) ==
-            0) {
-          indexs.push_back(leftOver.at(i)->getIndex());
-          centers.push_back(leftOver.at(i)->copy());
-          // cout << leftOver.at(i)->getIndex() << " ";
-          break;
-        }
-      }
-      left = right;
-    }
-    times++;
+    int id = seeder.sample(r * seeder.total());
+    if (id < 0)
+      continue;
+    centers.push_back(input.at(id)->copy());
+    seeder.addCentre(centers.back());
   }
-  // cout << endl;
 }
 
 /**
- * @Description: Calculate norm2 distance from point to one of the center
+ * @Description: Lloyd iterations over a flat copy of the input: assign every
+ * point to its nearest center, move every center to the mean of its points,
+ * and stop once no point changes its center. The final centers are written
+ * back into centers and the center of every point into assignment.
+ * With pruning, every point keeps Hamerly's bounds: the distance to its center
+ * and a lower bound of the distance to any other center. Points whose center
+ * is provably still the nearest skip the scan over the centers
  */
 
-double SESAME::KMeans::calculateEluDistance(PointPtr &point, PointPtr &center) {
-  double dist = 0;
-  for (int i = 0; i < point->getDimension(); i++) {
-    dist += pow(point->getFeatureItem(i) - center->getFeatureItem(i), 2);
+void SESAME::KMeans::lloydIterations(std::vector<PointPtr> &input,
+                                     std::vector<PointPtr> &centers,
+                                     std::vector<int> &assignment) {
+  int numberOfInput = (int)input.size();
+  int numberOfCenters = (int)centers.size();
+  int dim = numberOfInput == 0 ? 0 : input.front()->getDimension();
+  std::vector<double> points = flattenPoints(input, dim);
+  std::vector<double> means = flattenPoints(centers, dim);
+  // The update step sums the points in fixed blocks of at least 1024 points,
+  // at most 64 of them, each block into its own k x dim partial sums
+  int numberOfBlocks = std::min(64, (numberOfInput + 1023) / 1024);
+  size_t blockSize = (size_t)numberOfCenters * dim;
+  std::vector<double> sums(numberOfBlocks * blockSize);
+  std::vector<int> counts(numberOfCenters);
+
+  // Bounds of the pruned assignment: upper is the distance of every point to
+  // its center, lower bounds its distance to any other center, shifts holds
+  // how far every center moved, gaps the distances between the centers and
+  // halfGaps half the distance of every center to its nearest other center
+  std::vector<double> upper, lower, shifts, gaps, halfGaps, previous;
+  if (pruning) {
+    upper.resize(numberOfInput);
+    lower.resize(numberOfInput);
+    shifts.resize(numberOfCenters);
+    gaps.resize((size_t)numberOfCenters * numberOfCenters);
+    halfGaps.resize(numberOfCenters);
   }
-  dist = sqrt(dist);
-  return dist;
-}
-
-/**
- * @Description:  Calculate the new clustering center from groups
- */
-
-void SESAME::KMeans::calculateClusterCenter(PointPtr &center,
-                                            std::vector<PointPtr> &group) {
-  for (int i = 0; i < center->getDimension(); i++) {
-    double sum = 0;
-    if (!group.empty()) {
-      for (auto &j : group) {
-        sum += j->getFeatureItem(i);
+  // Scan all centers for the nearest one to point i, ties go to the first
+  auto nearestCenter = [&](int i) {
+    const double *point = &points[(size_t)i * dim];
+    int nearest = 0;
+    double minDist = std::numeric_limits<double>::max();
+    double secondDist = std::numeric_limits<double>::max();
+    for (int c = 0; c < numberOfCenters; c++) {
+      double dist = squaredDistance(point, &means[(size_t)c * dim], dim);
+      if (dist < minDist) {
+        secondDist = minDist;
+        minDist = dist;
+        nearest = c;
+      } else if (dist < secondDist) {
+        secondDist = dist;
       }
-      center->setFeatureItem(sum / double(group.size()), i);
     }
-  }
-}
-
-/**
- * @Description: Second Step: group every input points to the nearest centers
- */
-
-void SESAME::KMeans::groupPointsByCenters(
-    int numberOfCenters, int numberOfInput, std::vector<PointPtr> &input,
-    std::vector<PointPtr> &centers,
-    std::vector<std::vector<PointPtr>> &groups) {
-  for (int i = 0; i < centers.size(); i++) {
-    std::vector<PointPtr> initial;
-    groups.push_back(initial);
-  }
-  int Id;
-  for (int i = 0; i < input.size(); i++) {
-    double Min = calculateEluDistance(input.at(i), centers.at(0));
-    Id = 0; // cluster_id that the point belongs to
-    for (int j = 1; j < centers.size(); j++) {
-      if (Min > calculateEluDistance(input.at(i), centers.at(j))) {
-        Id = j;
-        Min = calculateEluDistance(input.at(i), centers.at(j));
+    if (pruning) {
+      upper[i] = std::sqrt(minDist);
+      lower[i] = std::sqrt(secondDist);
+    }
+    return nearest;
+  };
+
+  assignment.assign(numberOfInput, -1);
+  bool changed = true;
+  for (int iteration = 0; changed; iteration++) {
+    if (iteration > 0) {
+      if (pruning)
+        previous = means;
+      std::fill(counts.begin(), counts.end(), 0);
+      for (int i = 0; i < numberOfInput; i++)
+        counts[assignment[i]]++;
+      // The blocks do not depend on the number of threads, and the partial
+      // sums are added up in block order, so neither do the means
+#pragma omp parallel for schedule(static)
+      for (int block = 0; block < numberOfBlocks; block++) {
+        double *partial = &sums[block * blockSize];
+        std::fill(partial, partial + blockSize, 0.0);
+        int begin = (int)((long)numberOfInput * block / numberOfBlocks);
+        int end = (int)((long)numberOfInput * (block + 1) / numberOfBlocks);
+        for (int i = begin; i < end; i++) {
+          double *sum = partial + (size_t)assignment[i] * dim;
+          const double *point = &points[(size_t)i * dim];
+          for (int j = 0; j < dim; j++)
+            sum[j] += point[j];
+        }
+      }
+#pragma omp parallel for schedule(static)
+      for (int c = 0; c < numberOfCenters; c++) {
+        if (counts[c] == 0)
+          continue;
+        for (int j = 0; j < dim; j++) {
+          double sum = 0;
+          for (int block = 0; block < numberOfBlocks; block++)
+            sum += sums[block * blockSize + (size_t)c * dim + j];
+          means[(size_t)c * dim + j] = sum / double(counts[c]);
+        }
       }
     }
-    groups[Id].push_back(input.at(i));
-  }
-}
 
-/**
- * @Description: Third Step: choose new clustering center from group points
- * again
- */
+    changed = false;
+    if (!pruning || iteration == 0) {
+#pragma omp parallel for schedule(static) reduction(|| : changed)
+      for (int i = 0; i < numberOfInput; i++) {
+        int nearest = nearestCenter(i);
+        if (assignment[i] != nearest) {
+          assignment[i] = nearest;
+          changed = true;
+        }
+      }
+      continue;
+    }
 
-void SESAME::KMeans::adjustClusteringCenters(
-    std::vector<PointPtr> &centers,
-    std::vector<std::vector<PointPtr>> &groups) {
-  for (int i = 0; i < groups.size(); i++) {
-    calculateClusterCenter(centers[i], groups[i]);
+    int farthest = 0;
+    double maxShift = 0, secondShift = 0;
+    for (int c = 0; c < numberOfCenters; c++) {
+      shifts[c] = std::sqrt(squaredDistance(&previous[(size_t)c * dim],
+                                            &means[(size_t)c * dim], dim));
+      if (shifts[c] > maxShift) {
+        secondShift = maxShift;
+        maxShift = shifts[c];
+        farthest = c;
+      } else if (shifts[c] > secondShift) {
+        secondShift = shifts[c];
+      }
+    }
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int c = 0; c < numberOfCenters; c++) {
+      double minDist = std::numeric_limits<double>::max();
+      for (int other = 0; other < numberOfCenters; other++) {
+        double dist = c == other ? 0
+                                 : std::sqrt(squaredDistance(
+                                       &means[(size_t)c * dim],
+                                       &means[(size_t)other * dim], dim));
+        gaps[(size_t)c * numberOfCenters + other] = dist;
+        if (c != other)
+          minDist = std::min(minDist, dist);
+      }
+      halfGaps[c] = 0.5 * minDist;
+    }
+#pragma omp parallel for schedule(static) reduction(|| : changed)
+    for (int i = 0; i < numberOfInput; i++) {
+      const double *point = &points[(size_t)i * dim];
+      int center = assignment[i];
+      upper[i] += shifts[center];
+      lower[i] -= center == farthest ? secondShift : maxShift;
+      // Strict comparisons keep the first of equally near centers, as the scan
+      double bound = std::max(halfGaps[center], lower[i]);
+      if (upper[i] < bound)
+        continue;
+      double minDist =
+          squaredDistance(point, &means[(size_t)center * dim], dim);
+      upper[i] = std::sqrt(minDist);
+      if (upper[i] < bound)
+        continue;
+      // Rescan the centers, skipping those more than twice as far from the
+      // nearest center so far as the point is, which are farther from the
+      // point than that center
+      int nearest = center;
+      double secondLower = std::numeric_limits<double>::max();
+      for (int c = 0; c < numberOfCenters; c++) {
+        if (c == nearest)
+          continue;
+        double gap = gaps[(size_t)nearest * numberOfCenters + c];
+        if (gap > 2 * upper[i]) {
+          secondLower = std::min(secondLower, gap - upper[i]);
+          continue;
+        }
+        double dist = squaredDistance(point, &means[(size_t)c * dim], dim);
+        if (dist < minDist || (dist == minDist && c < nearest)) {
+          secondLower = std::min(secondLower, upper[i]);
+          nearest = c;
+          minDist = dist;
+          upper[i] = std::sqrt(dist);
+        } else {
+          secondLower = std::min(secondLower, std::sqrt(dist));
+        }
+      }
+      lower[i] = secondLower;
+      if (nearest != center) {
+        assignment[i] = nearest;
+        changed = true;
+      }
+    }
   }
-}
 
-/**
- * @Description: refresh group,replace the old one with the new one and clean up
- * the new group
- */
-
-void SESAME::KMeans::refreshGroup(
-    std::vector<std::vector<PointPtr>> &oldGroups,
-    std::vector<std::vector<PointPtr>> &newGroups) {
-  oldGroups.assign(newGroups.begin(), newGroups.end());
-  newGroups.clear();
-  std::vector<std::vector<PointPtr>> tmp;
-  newGroups.swap(tmp);
+  for (int c = 0; c < numberOfCenters; c++)
+    for (int j = 0; j < dim; j++)
+      centers[c]->setFeatureItem(means[(size_t)c * dim + j], j);
 }
 
 /**
- * @Description: if the old groups equals the new ones, set flagToStop to true
- * to stop KMeans
+ * @Description: collect the points of every center, in input order
  */
 
-void SESAME::KMeans::checkStopStatus(
-    bool &flag, std::vector<std::vector<PointPtr>> &oldGroups,
-    std::vector<std::vector<PointPtr>> &newGroups) {
-  flag = true;
-  if (oldGroups.size() == newGroups.size()) {
-    for (int i = 0; i < oldGroups.size(); i++) {
-      if (oldGroups[i].size() == newGroups[i].size()) {
-        for (int j = 1; j < oldGroups[i].size(); j++) {
-          if (oldGroups[i][j]->getIndex() != newGroups[i][j]->getIndex()) {
-            flag = false;
-          }
-        }
-      } else {
-        flag = false;
-      }
-    }
-  } else {
-    flag = false;
-  }
-  if (!flag) {
-    // SESAME_INFO("Point cluster need to be adjust, start a new iteration!");
-  }
+void SESAME::KMeans::groupByAssignment(
+    std::vector<PointPtr> &input, std::vector<int> &assignment,
+    int numberOfCenters, std::vector<std::vector<PointPtr>> &groups) {
+  groups.assign(numberOfCenters, std::vector<PointPtr>());
+  for (int i = 0; i < input.size(); i++)
+    groups[assignment[i]].push_back(input[i]);
 }
 
 /**
@@ -255,7 +311,6 @@ void SESAME::KMeans::runKMeans(int numberOfCenters, int numberOfInput,
                                std::vector<std::vector<PointPtr>> &oldGroups,
                                std::vector<std::vector<PointPtr>> &newGroups,
                                int seed, bool kmeanspp) {
-  bool flagToStop = false;
   srand(seed);
   if (kmeanspp) {
     // run the first step in KMeans++
@@ -263,35 +318,17 @@ void SESAME::KMeans::runKMeans(int numberOfCenters, int numberOfInput,
     randomSelectCenters(1, numberOfInput, input, centers);
     int resetCenter = numberOfCenters - 1;
     selectCentersFromWeight(resetCenter, numberOfInput, input, centers);
-
-    // run the second step in KMeans++
-    groupPointsByCenters(numberOfCenters, numberOfInput, input, centers,
-                         oldGroups);
   } else {
     SESAME_INFO("KMeans start!!!");
     // run the first step in KMeans
     randomSelectCenters(numberOfCenters, numberOfInput, input, centers);
-
-    // run the second step in KMeans
-    groupPointsByCenters(numberOfCenters, numberOfInput, input, centers,
-                         oldGroups);
   }
 
-  do {
-    // run the third step in KMeans
-    adjustClusteringCenters(centers, oldGroups);
-
-    // run the second step in KMeans
-    groupPointsByCenters(numberOfCenters, numberOfInput, input, centers,
-                         newGroups);
-
-    // check whether to stop
-    checkStopStatus(flagToStop, oldGroups, newGroups);
-
-    // refresh the groups, store newGroups in oldGroups and clean newGroups
-    refreshGroup(oldGroups, newGroups);
-
-  } while (!flagToStop);
+  // run the second and third steps in KMeans until the groups are stable
+  std::vector<int> assignment;
+  lloydIterations(input, centers, assignment);
+  groupByAssignment(input, assignment, (int)centers.size(), oldGroups);
+  newGroups.clear();
   if (kmeanspp) {
     SESAME_INFO("KMeans++ sourceEnd!!!");
   } else {
@@ -303,6 +340,7 @@ void SESAME::KMeans::Run(SESAME::SesameParam &param,
                          vector<PointPtr> &online_centers,
                          SESAME::DataSinkPtr sinkPtr) {
   srand(param.seed);
+  pruning = param.kmeans_pruning;
   if (online_centers.size() <= param.k or param.k < 2) {
     int i = 0;
     for (auto el : online_centers) {
@@ -310,11 +348,10 @@ void SESAME::KMeans::Run(SESAME::SesameParam &param,
       sinkPtr->put(el);
     }
   } else {
-    bool flagToStop = false;
     int numberOfCenters = param.k;
     int numberOfInput = (int)online_centers.size();
     std::vector<PointPtr> offlineCenters;
-    std::vector<std::vector<PointPtr>> oldGroups, newGroups;
+    std::vector<std::vector<PointPtr>> oldGroups;
 
     if (param.kmeanspp) {
       // run the first step in KMeans++
@@ -324,35 +361,18 @@ void SESAME::KMeans::Run(SESAME::SesameParam &param,
       selectCentersFromWeight(resetCenter, numberOfInput, online_centers,
                               offlineCenters);
 
-      // run the second step in KMeans++
-      groupPointsByCenters(numberOfCenters, numberOfInput, online_centers,
-                           offlineCenters, oldGroups);
     } else {
       SESAME_INFO("KMeans start!!!");
       // run the first step in KMeans
       randomSelectCenters(numberOfCenters, numberOfInput, online_centers,
                           offlineCenters);
-
-      // run the second step in KMeans
-      groupPointsByCenters(numberOfCenters, numberOfInput, online_centers,
-                           offlineCenters, oldGroups);
     }
 
-    do {
-      // run the third step in KMeans
-      adjustClusteringCenters(offlineCenters, oldGroups);
-
-      // run the second step in KMeans
-      groupPointsByCenters(numberOfCenters, numberOfInput, online_centers,
-                           offlineCenters, newGroups);
-
-      // check whether to stop
-      checkStopStatus(flagToStop, oldGroups, newGroups);
-
-      // refresh the groups, store newGroups in oldGroups and clean newGroups
-      refreshGroup(oldGroups, newGroups);
-
-    } while (!flagToStop);
+    // run the second and third steps in KMeans until the groups are stable
+    std::vector<int> assignment;
+    lloydIterations(online_centers, offlineCenters, assignment);
+    groupByAssignment(online_centers, assignment, (int)offlineCenters.size(),
+                      oldGroups);
     if (param.kmeanspp) {
       SESAME_INFO("KMeans++ sourceEnd!!!");
     } else {
@@ -366,6 +386,7 @@ void SESAME::KMeans::Run(SESAME::SesameParam &param,
                          vector<PointPtr> &online_centers,
                          vector<PointPtr> &results) {
   srand(param.seed);
+  pruning = param.kmeans_pruning;
   if (online_centers.size() <= param.k or param.k < 2) {
     int i = 0;
     for (auto el : online_centers) {
@@ -373,11 +394,10 @@ void SESAME::KMeans::Run(SESAME::SesameParam &param,
       results.push_back(el);
     }
   } else {
-    bool flagToStop = false;
     int numberOfCenters = param.k;
     int numberOfInput = (int)online_centers.size();
     std::vector<PointPtr> offlineCenters;
-    std::vector<std::vector<PointPtr>> oldGroups, newGroups;
+    std::vector<std::vector<PointPtr>> oldGroups;
 
     if (param.kmeanspp) {
       // run the first step in KMeans++
@@ -387,35 +407,18 @@ void SESAME::KMeans::Run(SESAME::SesameParam &param,
       selectCentersFromWeight(resetCenter, numberOfInput, online_centers,
                               offlineCenters);
 
-      // run the second step in KMeans++
-      groupPointsByCenters(numberOfCenters, numberOfInput, online_centers,
-                           offlineCenters, oldGroups);
     } else {
       SESAME_INFO("KMeans start!!!");
       // run the first step in KMeans
       randomSelectCenters(numberOfCenters, numberOfInput, online_centers,
                           offlineCenters);
-
-      // run the second step in KMeans
-      groupPointsByCenters(numberOfCenters, numberOfInput, online_centers,
-                           offlineCenters, oldGroups);
     }
 
-    do {
-      // run the third step in KMeans
-      adjustClusteringCenters(offlineCenters, oldGroups);
-
-      // run the second step in KMeans
-      groupPointsByCenters(numberOfCenters, numberOfInput, online_centers,
-                           offlineCenters, newGroups);
-
-      // check whether to stop
-      checkStopStatus(flagToStop, oldGroups, newGroups);
-
-      // refresh the groups, store newGroups in oldGroups and clean newGroups
-      refreshGroup(oldGroups, newGroups);
-
-    } while (!flagToStop);
+    // run the second and third steps in KMeans until the groups are stable
+    std::vector<int> assignment;
+    lloydIterations(online_centers, offlineCenters, assignment);
+    groupByAssignment(online_centers, assignment, (int)offlineCenters.size(),
+                      oldGroups);
     if (param.kmeanspp) {
       SESAME_INFO("KMeans++ sourceEnd!!!");
     } else {
@@ -0,0 +1,132 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#include <Algorithm/DataStructure/KMeansPPSeeder.hpp>
+#include <Algorithm/DataStructure/PointMatrix.hpp>
+#include <Algorithm/OfflineRefinement/MiniBatchKMeans.hpp>
+#include <Utils/Logger.hpp>
+#include <chrono>
+#include <limits>
+
+/**
+ * @Description: seed k centers with weighted kmeans++, move them by mini-batch
+ * steps within the budget, then assign every input point to its nearest center
+ */
+
+void SESAME::MiniBatchKMeans::refine(SesameParam &param,
+                                     std::vector<PointPtr> &input,
+                                     std::vector<int> &assignment) {
+  auto start = std::chrono::steady_clock::now();
+  int numberOfInput = (int)input.size();
+  int numberOfCenters = param.k;
+  int dim = input.front()->getDimension();
+  std::vector<double> points = flattenPoints(input, dim);
+  std::vector<double> weights(numberOfInput);
+  for (int i = 0; i < numberOfInput; i++)
+    weights[i] = input[i]->getWeight();
+
+  // run the first step in weighted KMeans++
+  std::mt19937 generator(param.seed);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<double> means;
+  means.reserve((size_t)numberOfCenters * dim);
+  KMeansPPSeeder seeder(input, weights);
+  int id = std::uniform_int_distribution<int>(0, numberOfInput - 1)(generator);
+  while ((int)means.size() < numberOfCenters * dim) {
+    means.insert(means.end(), &points[(size_t)id * dim],
+                 &points[(size_t)(id + 1) * dim]);
+    seeder.addCentre(input[id]);
+    if (seeder.exhausted())
+      break;
+    do
+      id = seeder.sample(unit(generator) * seeder.total());
+    while (id < 0);
+  }
+  numberOfCenters = (int)(means.size() / dim);
+
+  // move the centers by weighted mini-batch steps, each center by the running
+  // weighted mean of the points it won
+  auto nearestCenter = [&](const double *point) {
+    int nearest = 0;
+    double minDist = std::numeric_limits<double>::max();
+    for (int c = 0; c < numberOfCenters; c++) {
+      double dist = squaredDistance(point, &means[(size_t)c * dim], dim);
+      if (dist < minDist) {
+        minDist = dist;
+        nearest = c;
+      }
+    }
+    return nearest;
+  };
+  int batchSize = std::min(param.mini_batch_size, numberOfInput);
+  std::uniform_int_distribution<int> pick(0, numberOfInput - 1);
+  std::vector<int> batch(batchSize), batchCenters(batchSize);
+  std::vector<double> centerWeights(numberOfCenters, 0.0);
+  for (int iteration = 0; iteration < param.mini_batch_iterations;
+       iteration++) {
+    if (param.mini_batch_budget_ms > 0 &&
+        std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start)
+                .count() > param.mini_batch_budget_ms)
+      break;
+    for (auto &index : batch)
+      index = pick(generator);
+#pragma omp parallel for schedule(static)
+    for (int b = 0; b < batchSize; b++)
+      batchCenters[b] = nearestCenter(&points[(size_t)batch[b] * dim]);
+    for (int b = 0; b < batchSize; b++) {
+      int c = batchCenters[b];
+      double weight = weights[batch[b]];
+      if (!(weight > 0))
+        continue;
+      centerWeights[c] += weight;
+      double rate = weight / centerWeights[c];
+      double *mean = &means[(size_t)c * dim];
+      const double *point = &points[(size_t)batch[b] * dim];
+      for (int j = 0; j < dim; j++)
+        mean[j] += rate * (point[j] - mean[j]);
+    }
+  }
+
+  // run the second step in KMeans once with the final centers
+  assignment.resize(numberOfInput);
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < numberOfInput; i++)
+    assignment[i] = nearestCenter(&points[(size_t)i * dim]);
+}
+
+void SESAME::MiniBatchKMeans::Run(SESAME::SesameParam &param,
+                                  std::vector<PointPtr> &online_centers,
+                                  SESAME::DataSinkPtr sinkPtr) {
+  std::vector<PointPtr> results;
+  Run(param, online_centers, results);
+  for (auto &result : results)
+    sinkPtr->put(result);
+}
+
+void SESAME::MiniBatchKMeans::Run(SESAME::SesameParam &param,
+                                  std::vector<PointPtr> &online_centers,
+                                  std::vector<PointPtr> &results) {
+  if (online_centers.size() <= param.k or param.k < 2) {
+    int i = 0;
+    for (auto el : online_centers) {
+      el->setClusteringCenter(i++);
+      results.push_back(el);
+    }
+    return;
+  }
+  SESAME_INFO("MiniBatchKMeans start!!!");
+  std::vector<int> assignment;
+  refine(param, online_centers, assignment);
+  // output the points grouped by center, in input order within a group
+  std::vector<std::vector<int>> groups(param.k);
+  for (int i = 0; i < online_centers.size(); i++)
+    groups[assignment[i]].push_back(i);
+  for (int c = 0; c < groups.size(); c++) {
+    for (int i : groups[c]) {
+      online_centers[i]->setClusteringCenter(c);
+      results.push_back(online_centers[i]->copy());
+    }
+  }
+  SESAME_INFO("MiniBatchKMeans sourceEnd!!!");
+}
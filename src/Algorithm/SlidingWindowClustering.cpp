@@ -1,7 +1,9 @@
 #include "Algorithm/SlidingWindowClustering.hpp"
 #include "Algorithm/DataStructure/GenericFactory.hpp"
+#include "Algorithm/DataStructure/KMeansPPSeeder.hpp"
 
 #include <cassert>
+#include <climits>
 
 namespace SESAME {
 SlidingWindowClustering::SlidingWindowClustering(param_t &cmd_params)
@@ -18,51 +20,38 @@ void k_means_plus_plus(Random *r,
                        int32_t k, std::vector<int32_t> *centers, double *cost) {
   centers->clear();
 
-  std::vector<double> min_distance_to_centers(
-      instance.size(), std::numeric_limits<double>::max());
+  std::vector<PointPtr> points;
+  std::vector<double> weights;
+  points.reserve(instance.size());
+  weights.reserve(instance.size());
+  for (const auto &[point, weight] : instance) {
+    points.push_back(point);
+    weights.push_back(weight);
+  }
+  KMeansPPSeeder seeder(points, weights);
 
   if (k >= instance.size()) {
     for (int32_t i = 0; i < instance.size(); i++) {
       centers->push_back(i);
+      seeder.addCentre(points[i]);
     }
   } else {
     // add u.a.r. center.
     auto index = r->random_uniform(0, (int)instance.size() - 1);
     centers->push_back(index);
+    seeder.addCentre(points[index]);
     while (centers->size() < k) {
-      double sum_pow_min_distances = 0.0;
-      vector<double> min_dist_powers;
-      min_dist_powers.reserve(instance.size());
-
-      for (int pos = 0; pos < instance.size(); ++pos) {
-        double min_distance = std::min(
-            min_distance_to_centers.at(pos),
-            instance[pos].first->L2Dist(instance.at(centers->back()).first));
-        min_distance_to_centers[pos] = min_distance;
-        sum_pow_min_distances +=
-            std::pow(min_distance, 2) * instance.at(pos).second;
-        min_dist_powers.push_back(std::pow(min_distance, 2) *
-                                  instance.at(pos).second);
-      }
-
-      double random_place = r->random_uniform(0.0, sum_pow_min_distances);
-      for (int32_t i = 0; i < instance.size(); i++) {
-        if (random_place <= min_dist_powers[i]) {
-          centers->push_back(i);
-          break;
-        }
-        random_place -= min_dist_powers[i];
+      if (seeder.exhausted())
+        break;
+      int32_t chosen = seeder.sample(r->random_uniform(0.0, seeder.total()));
+      if (chosen >= 0) {
+        centers->push_back(chosen);
+        seeder.addCentre(points[chosen]);
       }
     }
   }
 
-  *cost = 0;
-  for (int pos = 0; pos < instance.size(); ++pos) {
-    double min_distance =
-        std::min(min_distance_to_centers.at(pos),
-                 instance[pos].first->L2Dist(instance[centers->back()].first));
-    *cost += std::pow(min_distance, 2) * instance.at(pos).second;
-  }
+  *cost = seeder.total();
 }
 
 // Given a series of instances of the problem, runs the k-means++ algorithm on
@@ -87,6 +76,29 @@ vector<double> cost_samples(Random *r, const vector<PointPtr> &samples,
   return costs;
 }
 
+// Same as above, but the instances are solved in parallel on workers threads,
+// each instance with its own random source seeded from seeds.
+vector<double> cost_samples(const vector<int> &seeds,
+                            const vector<PointPtr> &samples, int window_size,
+                            int num_samples, int k, int workers) {
+  vector<double> costs(num_samples, 0.0);
+#pragma omp parallel for num_threads(workers) schedule(dynamic)
+  for (int i = 0; i < num_samples; i++) {
+    Random sample_r(seeds[i]);
+    std::vector<std::pair<PointPtr, double>> instance;
+    instance.reserve(window_size);
+    for (int j = 0; j < window_size; j++) {
+      instance.push_back(std::make_pair(samples[i * window_size + j], 1.0));
+    }
+    std::vector<int32_t> ingnored_centers;
+    k_means_plus_plus(&sample_r, instance, k, &ingnored_centers, &costs[i]);
+  }
+  costs.erase(std::remove_if(costs.begin(), costs.end(),
+                             [](double cost) { return !(cost > 0); }),
+              costs.end());
+  return costs;
+}
+
 // Given a vector of costs, guesses a range for the optimum value. This is done
 // by using a heuristic based on the min/max value and the standard deviation.
 // Outputs the min and max bounds as a pair.
@@ -117,24 +129,60 @@ guess_optimum_range_bounds(Random *r, const vector<PointPtr> &samples,
   return guess_bounds(costs);
 }
 
+std::pair<double, double>
+guess_optimum_range_bounds(const vector<int> &seeds,
+                           const vector<PointPtr> &samples, int window_size,
+                           int num_samples, int k, int workers) {
+  auto costs =
+      cost_samples(seeds, samples, window_size, num_samples, k, workers);
+  return guess_bounds(costs);
+}
+
 void SlidingWindowClustering::RunOnline(PointPtr input) {
   ++count;
   if (!has_sampled) {
     win_timer.Tick();
-    if (samples.size() < param.num_samples * param.sliding)
+    size_t num_sampled = param.num_samples * param.sliding;
+    if (samples.size() < num_sampled) {
       samples.push_back(input);
-    if (samples.size() >= param.num_samples * param.sliding) {
-      const auto &[lower_bound, upper_bound] = guess_optimum_range_bounds(
-          &r, samples, param.sliding, param.num_samples, param.num_clusters);
-      framework = GenericFactory::New<FrameworkAlg<KMeansSummary>>(
-          &r, param.sliding, param.num_clusters, param.delta_grid, lower_bound,
-          upper_bound);
-      for (auto p : samples) {
-        framework->process_point(p);
+      if (samples.size() == num_sampled) {
+        // Guess the bounds in the background, later points are buffered
+        // until the framework can be built. r is not touched here until then.
+        if (param.guess_workers > 0) {
+          vector<int> seeds(param.num_samples);
+          for (auto &seed : seeds) {
+            seed = r.random_uniform(0, INT_MAX);
+          }
+          bounds = std::async(std::launch::async, [this, seeds]() {
+            return guess_optimum_range_bounds(
+                seeds, samples, param.sliding, param.num_samples,
+                param.num_clusters, param.guess_workers);
+          });
+        } else {
+          bounds = std::async(std::launch::async, [this]() {
+            return guess_optimum_range_bounds(&r, samples, param.sliding,
+                                              param.num_samples,
+                                              param.num_clusters);
+          });
+        }
       }
-      has_sampled = true;
+    } else {
+      pending.push_back(input);
+    }
+    // Once a window of points is waiting, ingest waits for the bounds rather
+    // than buffering without limit
+    if (bounds.valid() &&
+        (pending.size() >= (size_t)param.sliding ||
+         bounds.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready)) {
+      build_framework();
     }
     win_timer.Tock();
+  } else if (!pending.empty()) {
+    ds_timer.Tick();
+    pending.push_back(input);
+    drain_pending(drain_slice);
+    ds_timer.Tock();
   } else {
     ds_timer.Tick();
     framework->process_point(input);
@@ -143,9 +191,30 @@ void SlidingWindowClustering::RunOnline(PointPtr input) {
   lat_timer.Add(input->toa);
 }
 
+void SlidingWindowClustering::build_framework() {
+  const auto &[lower_bound, upper_bound] = bounds.get();
+  framework = GenericFactory::New<FrameworkAlg<KMeansSummary>>(
+      &r, param.sliding, param.num_clusters, param.delta_grid, lower_bound,
+      upper_bound, param.guess_workers);
+  pending.insert(pending.begin(), samples.begin(), samples.end());
+  std::vector<PointPtr>().swap(samples);
+  has_sampled = true;
+}
+
+void SlidingWindowClustering::drain_pending(size_t max_points) {
+  for (size_t i = 0; i < max_points && !pending.empty(); i++) {
+    framework->process_point(pending.front());
+    pending.pop_front();
+  }
+}
+
 void SlidingWindowClustering::RunOffline(DataSinkPtr sinkPtr) {
   on_timer.Add(sum_timer.start);
   ref_timer.Tick();
+  if (!has_sampled && bounds.valid()) {
+    build_framework();
+  }
+  drain_pending(pending.size());
   std::vector<PointPtr> online_centers;
   double cost_estimate = 0;
   framework->solution(&online_centers, &cost_estimate);
@@ -24,6 +24,10 @@ void SESAME::StreamKM::Init() {
   this->window->windowManager.maxWindowSize = this->StreamKMParam.windowSize;
   this->window->initWindow(this->StreamKMParam.windowSize);
   this->window->tree = GenericFactory::New<LandmarkWindow::CoresetTree>(param);
+  this->km = KMeans(this->param);
+  if (this->param.merge_workers > 0)
+    this->window->initAsyncMerge(this->param.merge_workers,
+                                 this->StreamKMParam.seed);
   SESAME_DEBUG("Created manager with "
                << this->window->windowManager.numberOfWindow
                << " windows of dim: " << this->StreamKMParam.dim);
@@ -103,534 +107,221 @@ void SESAME::LandmarkWindow::CoresetTree::unionTreeCoreset(
   //  SESAME_DEBUG("Computing coreset...");
   // total number of points
   int n = n_1 + n_2;
-  // choose the first centre (each point has the same probability of being
-  // choosen) stores, how many centres have been choosen yet
-  int choosenPoints = 0;
-  // only choose from the n-i points not already choosen
-  int j = UtilityFunctions::genrand_int31() % (n - choosenPoints);
-
-  // copy the choosen point
-  if (j < n_1) {
-    centres[choosenPoints] = setA[j]->copy(); // TODO: ???? why re-set setA[j]?
-  } else {
-    j = j - n_1;
-    centres[choosenPoints] = setB[j]->copy(); // TODO: ???? why re-set setB[j]?
+  auto pointAt = [&](int i) -> const PointPtr & {
+    return i < n_1 ? setA[i] : setB[i - n_1];
+  };
+  // gather the centroid coordinates of the union once, the tree only works on
+  // union indices from here on
+  dim = pointAt(0)->getDimension();
+  centroids.resize((size_t)n * dim);
+  weights.resize(n);
+  assignment.assign(n, 0);
+  order.resize(n);
+  scratch.resize(n);
+  for (int i = 0; i < n; i++) {
+    const PointPtr &point = pointAt(i);
+    weights[i] = point->getWeight();
+    for (int l = 0; l < dim; l++) {
+      double coordinate = point->getFeatureItem(l);
+      centroids[(size_t)i * dim + l] =
+          weights[i] != 0.0 ? coordinate / weights[i] : coordinate;
+    }
+    order[i] = i;
   }
-  //  struct treeNode *root = (struct treeNode *) malloc(sizeof(struct
-  //  treeNode));
-  TreeNodePtr root = DataStructureFactory::createTreeNode();
-  constructRoot(root, setA, setB, n_1, n_2, centres[choosenPoints],
-                choosenPoints);
-  choosenPoints = 1;
 
-  // choose the remaining points
-  while (choosenPoints < k) {
-    if (root->cost > 0.0) {
-      TreeNodePtr leaf = selectNode(root);
-      PointPtr centre = chooseCentre(leaf);
+  // choose the first centre (each point has the same probability of being
+  // choosen), the root holds all points
+  centreOf.assign(k, -1);
+  centreOf[0] = randomInt31() % n;
+  nodes.clear();
+  nodes.push_back(Node{0, n, centreOf[0], -1, -1, -1, 0.0});
+  treeNodeTargetFunctionValue(nodes[0]);
+
+  // choose the remaining points, a dummy centre once the root has no cost
+  for (int choosenPoints = 1; choosenPoints < k; choosenPoints++) {
+    if (nodes[0].cost > 0.0) {
+      int leaf = selectNode();
+      int centre = chooseCentre(leaf);
       split(leaf, centre, choosenPoints);
-      centres[choosenPoints] = centre->copy();
-    } else {
-      // create a dummy point
-      centres[choosenPoints] = root->centre->copy();
-      int l;
-      for (l = 0; l < centres[choosenPoints]->getDimension(); l++) {
-        centres[choosenPoints]->setFeatureItem(-1 * 1000000, l);
-      }
-      centres[choosenPoints]->setIndex(-1);
-      centres[choosenPoints]->setWeight(0.0);
+      centreOf[choosenPoints] = centre;
     }
-
-    choosenPoints++;
   }
 
-  // free the tree
-  freeTree(root);
-
-  // recalculate clustering features
-  int i;
-  for (i = 0; i < n; i++) {
-    if (i < n_1) {
-      int index = setA[i]->getClusteringCenter();
-      if (centres[index]->getIndex() != setA[i]->getIndex()) {
-        centres[index]->setWeight(centres[index]->getWeight() +
-                                  setA[i]->getWeight());
-        int l;
-        for (l = 0; l < setA[i]->getDimension(); l++) {
-          if (setA[i]->getWeight() != 0.0) {
-            centres[index]->setFeatureItem(
-                setA[i]->getFeatureItem(l) + centres[index]->getFeatureItem(l),
-                l);
-          }
-        }
-      }
-    } else {
-      int index = setB[i - n_1]->getClusteringCenter();
-      if (centres[index]->getIndex() != setB[i - n_1]->getIndex()) {
-        centres[index]->setWeight(centres[index]->getWeight() +
-                                  setB[i - n_1]->getWeight());
-        int l;
-        for (l = 0; l < setB[i - n_1]->getDimension(); l++) {
-          if (setB[i - n_1]->getWeight() != 0.0) {
-            centres[index]->setFeatureItem(
-                setB[i - n_1]->getFeatureItem(l) +
-                    centres[index]->getFeatureItem(l),
-                l);
-          }
-        }
-      }
+  // recalculate clustering features: each centre sums up the points assigned
+  // to it
+  const Point &root = *pointAt(centreOf[0]);
+  for (int c = 0; c < k; c++) {
+    if (centreOf[c] >= 0) {
+      LandmarkWindow::assignPoint(centres[c], *pointAt(centreOf[c]));
+      continue;
     }
+    LandmarkWindow::assignPoint(centres[c], root);
+    for (int l = 0; l < centres[c]->getDimension(); l++)
+      centres[c]->setFeatureItem(-1 * 1000000, l);
+    centres[c]->setIndex(-1);
+    centres[c]->setWeight(0.0);
   }
-}
-
-void SESAME::LandmarkWindow::CoresetTree::freeTree(TreeNodePtr root) {
-  while (!treeFinished(root)) {
-    if (root->lc == NULL && root->rc == NULL) {
-      root = root->parent;
-    } else if (root->lc == NULL && root->rc != NULL) {
-      // Schau ob rc ein Blatt ist
-      if (isLeaf(root->rc)) {
-        // Gebe rechtes Kind frei
-        root->rc->points.clear();
-        DataStructureFactory::clearTreeNode(root->rc);
-        root->rc = NULL;
-      } else {
-        // Fahre mit rechtem Kind fort
-        root = root->rc;
-      }
-    } else if (root->lc != NULL) {
-      if (isLeaf(root->lc)) {
-        root->lc->points.clear();
-        DataStructureFactory::clearTreeNode(root->lc);
-        root->lc = NULL;
-      } else {
-        root = root->lc;
-      }
+  for (int i = 0; i < n; i++) {
+    int index = assignment[i];
+    if (centreOf[index] == i)
+      continue;
+    const PointPtr &point = pointAt(i);
+    centres[index]->setWeight(centres[index]->getWeight() + point->getWeight());
+    if (point->getWeight() != 0.0) {
+      for (int l = 0; l < point->getDimension(); l++)
+        centres[index]->setFeatureItem(point->getFeatureItem(l) +
+                                           centres[index]->getFeatureItem(l),
+                                       l);
     }
   }
-  root->points.clear();
-  root.reset();
 }
 
-bool SESAME::LandmarkWindow::CoresetTree::treeFinished(TreeNodePtr root) {
-  if (root->parent == NULL && root->lc == NULL && root->rc == NULL) {
-    return 1;
-  } else {
-    return 0;
-  }
+void SESAME::LandmarkWindow::CoresetTree::seed(unsigned long seed) {
+  generator.seed(seed);
+  seeded = true;
 }
 
-bool SESAME::LandmarkWindow::CoresetTree::isLeaf(TreeNodePtr node) {
-  if (node->lc == NULL && node->rc == NULL) {
-    return 1;
-  } else {
-    return 0;
-  }
+// A seeded tree draws like genrand_int31 and genrand_real3, from its own
+// MT19937
+long SESAME::LandmarkWindow::CoresetTree::randomInt31() {
+  if (!seeded)
+    return UtilityFunctions::genrand_int31();
+  return (long)(generator() >> 1);
 }
 
-void SESAME::LandmarkWindow::CoresetTree::constructRoot(
-    TreeNodePtr root, std::vector<PointPtr> &setA, std::vector<PointPtr> &setB,
-    int n_1, int n_2, PointPtr centre, int centreIndex) {
-  // loop counter variable
-  int i;
-  // the root has no parent and no child nodes in the beginning
-  root->parent = NULL;
-  root->lc = NULL;
-  root->rc = NULL;
-
-  // array with points to the points
-  // root->points= new Point[n_1 + n_2];
-  root->n = n_1 + n_2;
-
-  for (i = 0; i < root->n; i++) {
-    if (i < n_1) {
-      root->points.push_back(setA[i]);
-      //      root->points[i] = setA[i];
-      root->points[i]->setClusteringCenter(centreIndex);
-    } else {
-      root->points.push_back(setB[i - n_1]);
-      root->points[i]->setClusteringCenter(centreIndex);
-    }
-  }
-
-  // set the centre
-  root->centre = centre;
+double SESAME::LandmarkWindow::CoresetTree::randomReal3() {
+  if (!seeded)
+    return UtilityFunctions::genrand_real3();
+  return (((double)generator()) + 0.5) * (1.0 / 4294967296.0);
+}
 
-  // calculate costs
-  treeNodeTargetFunctionValue(root);
+double SESAME::LandmarkWindow::CoresetTree::distance(int point,
+                                                     int centre) const {
+  const double *a = &centroids[(size_t)point * dim];
+  const double *b = &centroids[(size_t)centre * dim];
+  double distance = 0.0;
+  for (int l = 0; l < dim; l++)
+    distance += (a[l] - b[l]) * (a[l] - b[l]);
+  return distance;
 }
 
 void SESAME::LandmarkWindow::CoresetTree::treeNodeTargetFunctionValue(
-    TreeNodePtr node) {
-  // loop counter variable
-  int i;
-
-  // stores the cost
+    Node &node) const {
   double sum = 0.0;
-
-  for (i = 0; i < node->n; i++) {
-    // stores the distance
-    double distance = 0.0;
-
-    // loop counter variable
-    int l;
-
-    for (l = 0; l < node->points[i]->getDimension(); l++) {
-      // centroid coordinate of the point
-      double centroidCoordinatePoint;
-      if (node->points[i]->getWeight() != 0.0) {
-        centroidCoordinatePoint =
-            node->points[i]->getFeatureItem(l) / node->points[i]->getWeight();
-      } else {
-        centroidCoordinatePoint = node->points[i]->getFeatureItem(l);
-      }
-      // centroid coordinate of the centre
-      double centroidCoordinateCentre;
-      if (node->centre->getWeight() != 0.0) {
-        centroidCoordinateCentre =
-            node->centre->getFeatureItem(l) / node->centre->getWeight();
-      } else {
-        centroidCoordinateCentre = node->centre->getFeatureItem(l);
-      }
-      distance += (centroidCoordinatePoint - centroidCoordinateCentre) *
-                  (centroidCoordinatePoint - centroidCoordinateCentre);
-    }
-    sum += distance * node->points[i]->getWeight();
-  }
-  node->cost = sum;
+  for (int i = node.begin; i < node.end; i++)
+    sum += distance(order[i], node.centre) * weights[order[i]];
+  node.cost = sum;
 }
 
-SESAME::TreeNodePtr
-SESAME::LandmarkWindow::CoresetTree::selectNode(TreeNodePtr root) {
+int SESAME::LandmarkWindow::CoresetTree::selectNode() {
   // random number between 0 and 1
-  double random = UtilityFunctions::genrand_real3();
-  while (!isLeaf(root)) {
-    if (root->lc->cost == 0 && root->rc->cost == 0) {
-      if (root->lc->n == 0) {
-        root = root->rc;
-      } else if (root->rc->n == 0) {
-        root = root->lc;
+  double random = randomReal3();
+  int node = 0;
+  while (nodes[node].lc >= 0) {
+    const Node &lc = nodes[nodes[node].lc], &rc = nodes[nodes[node].rc];
+    if (lc.cost == 0 && rc.cost == 0) {
+      if (lc.begin == lc.end) {
+        node = nodes[node].rc;
+      } else if (rc.begin == rc.end) {
+        node = nodes[node].lc;
       } else if (random < 0.5) {
-        random = UtilityFunctions::genrand_real3();
-        root = root->lc;
+        random = randomReal3();
+        node = nodes[node].lc;
       } else {
-        random = UtilityFunctions::genrand_real3();
-        root = root->rc;
+        random = randomReal3();
+        node = nodes[node].rc;
       }
     } else {
-      if (random < root->lc->cost / root->cost) {
-        root = root->lc;
-      } else {
-        root = root->rc;
-      }
+      node = random < lc.cost / nodes[node].cost ? nodes[node].lc
+                                                 : nodes[node].rc;
     }
   }
-
-  return root;
+  return node;
 }
 
 /**
  * selects a new centre from the treenode (using the kMeans++ distribution)
  * TODO: Why hard-code??
  */
-SESAME::PointPtr
-SESAME::LandmarkWindow::CoresetTree::chooseCentre(TreeNodePtr node) {
+int SESAME::LandmarkWindow::CoresetTree::chooseCentre(int node) {
   // TODO: How many times should we try to choose a centre ??
   int times = 3;
+  const Node &leaf = nodes[node];
 
   // stores the nodecost if node is split with the best centre
-  double minCost = node->cost;
-  PointPtr bestCentre = GenericFactory::New<Point>(param.dim);
+  double minCost = leaf.cost;
+  int bestCentre = -1;
 
   for (int j = 0; j < times; j++) {
     // sum of the relativ cost of the points
     double sum = 0.0;
     // random number between 0 and 1
-    double random = UtilityFunctions::genrand_real3();
+    double random = randomReal3();
 
-    for (int i = 0; i < node->n; i++) {
-      sum += treeNodeCostOfPoint(node, node->points[i]) / node->cost;
+    for (int i = leaf.begin; i < leaf.end; i++) {
+      int point = order[i];
+      sum += distance(point, leaf.centre) * weights[point] / leaf.cost;
       if (sum >= random) {
-        if (node->points[i]->getWeight() == 0.0) {
+        if (weights[point] == 0.0) {
           SESAME_INFO("ERROR: CHOOSEN DUMMY NODE THOUGH OTHER AVAILABLE \n");
-          return bestCentre;
+          return bestCentre >= 0 ? bestCentre : order[leaf.begin];
         }
-        double curCost = treeNodeSplitCost(node, node->centre, node->points[i]);
+        double curCost = treeNodeSplitCost(node, point);
         if (curCost < minCost) {
-          bestCentre = node->points[i];
+          bestCentre = point;
           minCost = curCost;
         }
         break;
       }
     }
   }
-  if (bestCentre->getIndex() == -1) {
-    return node->points[0];
-  } else {
-    return bestCentre;
-  }
-}
-
-double
-SESAME::LandmarkWindow::CoresetTree::treeNodeCostOfPoint(TreeNodePtr node,
-                                                         PointPtr p) {
-  if (p->getWeight() == 0.0) {
-    return 0.0;
-  }
-
-  // stores the distance between centre and p
-  double distance = 0.0;
-
-  // loop counter variable
-  int l;
-
-  for (l = 0; l < p->getDimension(); l++) {
-    // centroid coor->inate of the point
-    double centroidCoordinatePoint;
-    if (p->getWeight() != 0.0) {
-      centroidCoordinatePoint = p->getFeatureItem(l) / p->getWeight();
-    } else {
-      centroidCoordinatePoint = p->getFeatureItem(l);
-    }
-    // centroid coordinate of the centre
-    double centroidCoordinateCentre;
-    if (node->centre->getWeight() != 0.0) {
-      centroidCoordinateCentre =
-          node->centre->getFeatureItem(l) / node->centre->getWeight();
-    } else {
-      centroidCoordinateCentre = node->centre->getFeatureItem(l);
-    }
-    distance += (centroidCoordinatePoint - centroidCoordinateCentre) *
-                (centroidCoordinatePoint - centroidCoordinateCentre);
-  }
-  return distance * p->getWeight();
+  return bestCentre >= 0 ? bestCentre : order[leaf.begin];
 }
 
 /**
- * computes the hypothetical cost if the node would be split with new centers
- * centreA, centreB
- * @param node
- * @param centreA
- * @param centreB
- * @return
+ * computes the hypothetical cost if the node would be split with its centre
+ * and the new centre
  */
 double SESAME::LandmarkWindow::CoresetTree::treeNodeSplitCost(
-    TreeNodePtr node, PointPtr centreA, PointPtr centreB) {
-  // loop counter variable
-  int i;
-  // stores the cost
+    int node, int centre) const {
   double sum = 0.0;
-  for (i = 0; i < node->n; i++) {
-    // loop counter variable
-    int l;
-    // stores the distance between p and centreA
-    double distanceA = 0.0;
-    for (l = 0; l < node->points[i]->getDimension(); l++) {
-      // centroid coordinate of the point
-      double centroidCoordinatePoint;
-      if (node->points[i]->getWeight() != 0.0) {
-        centroidCoordinatePoint =
-            node->points[i]->getFeatureItem(l) / node->points[i]->getWeight();
-      } else {
-        centroidCoordinatePoint = node->points[i]->getFeatureItem(l);
-      }
-      // centroid coordinate of the centre
-      double centroidCoordinateCentre;
-      if (centreA->getWeight() != 0.0) {
-        centroidCoordinateCentre =
-            centreA->getFeatureItem(l) / centreA->getWeight();
-      } else {
-        centroidCoordinateCentre = centreA->getFeatureItem(l);
-      }
-      distanceA += (centroidCoordinatePoint - centroidCoordinateCentre) *
-                   (centroidCoordinatePoint - centroidCoordinateCentre);
-    }
-    // stores the distance between p and centreB
-    double distanceB = 0.0;
-    for (l = 0; l < node->points[i]->getDimension(); l++) {
-      // centroid coordinate of the point
-      double centroidCoordinatePoint;
-      if (node->points[i]->getWeight() != 0.0) {
-        centroidCoordinatePoint =
-            node->points[i]->getFeatureItem(l) / node->points[i]->getWeight();
-      } else {
-        centroidCoordinatePoint = node->points[i]->getFeatureItem(l);
-      }
-      // centroid coordinate of the centre
-      double centroidCoordinateCentre;
-      if (centreB->getWeight() != 0.0) {
-        centroidCoordinateCentre =
-            centreB->getFeatureItem(l) / centreB->getWeight();
-      } else {
-        centroidCoordinateCentre = centreB->getFeatureItem(l);
-      }
-
-      distanceB += (centroidCoordinatePoint - centroidCoordinateCentre) *
-                   (centroidCoordinatePoint - centroidCoordinateCentre);
-    }
+  for (int i = nodes[node].begin; i < nodes[node].end; i++) {
+    int point = order[i];
+    double distanceA = distance(point, nodes[node].centre);
+    double distanceB = distance(point, centre);
     // add the cost of the closest centre to the sum
-    if (distanceA < distanceB) {
-      sum += distanceA * node->points[i]->getWeight();
-    } else {
-      sum += distanceB * node->points[i]->getWeight();
-    }
+    sum += (distanceA < distanceB ? distanceA : distanceB) * weights[point];
   }
-  // return the total cost
   return sum;
 }
 
-/**
-splits the parent node and creates two child nodes (one with the old centre and
-one with the new one)
-**/
-void SESAME::LandmarkWindow::CoresetTree::split(TreeNodePtr parent,
-                                                PointPtr newCentre,
+void SESAME::LandmarkWindow::CoresetTree::split(int node, int newCentre,
                                                 int newCentreIndex) {
-  // loop counter variable
-  int i = 0;
-
-  // 1. Counts how many points belong to the new and how many points belong to
-  // the old centre
-  int nOld = 0;
-  int nNew = 0;
-  for (i = 0; i < parent->n; i++) {
-    PointPtr centre =
-        determineClosestCentre(parent->points[i], parent->centre, newCentre);
-    if (centre->getIndex() == newCentre->getIndex()) {
-      nNew++;
-    } else {
-      nOld++;
-    }
-  }
-
-  // 2. initalizes the arrays for the pointer
-  // array for pointer on the points belonging to the old centre
-  std::vector<PointPtr> oldPoints; // = new Point[nOld];
-                                   //  for(i = 0; i < nOld; i++) {
-                                   //
-                                   //  }
-  // array for pointer on the points belonging to the new centre
-  std::vector<PointPtr> newPoints; //= new Point[nNew];
-
-  int indexOld = 0;
-  int indexNew = 0;
-
-  for (i = 0; i < parent->n; i++) {
-    PointPtr centre =
-        determineClosestCentre(parent->points[i], parent->centre, newCentre);
-    if (centre->getIndex() == newCentre->getIndex()) {
-      newPoints.push_back(parent->points[i]);
-      newPoints[indexNew]->setClusteringCenter(newCentreIndex);
-      indexNew++;
-    } else if (centre->getIndex() == parent->centre->getIndex()) {
-      oldPoints.push_back(parent->points[i]);
-      indexOld++;
+  // Stable partition of the node's range: points closer to the old centre
+  // first (left child), then the points of the new centre (right child)
+  int begin = nodes[node].begin, end = nodes[node].end;
+  int nOld = begin, nNew = 0;
+  for (int i = begin; i < end; i++) {
+    int point = order[i];
+    if (distance(point, nodes[node].centre) < distance(point, newCentre)) {
+      order[nOld++] = point;
     } else {
-      SESAME_INFO("ERROR !!! NO CENTER NEAREST !! \n");
+      assignment[point] = newCentreIndex;
+      scratch[nNew++] = point;
     }
   }
+  std::copy(scratch.begin(), scratch.begin() + nNew, order.begin() + nOld);
 
-  // left child: old centre
-  //  struct TreeNode *lc = (struct TreeNode *) malloc(sizeof(struct TreeNode));
-  TreeNodePtr lc = DataStructureFactory::createTreeNode();
-  lc->centre = parent->centre;
-  lc->points = oldPoints;
-  lc->n = nOld;
-
-  lc->lc = NULL;
-  lc->rc = NULL;
-  lc->parent = parent;
-
-  treeNodeTargetFunctionValue(lc);
-
-  // right child: new centre
-  //  struct TreeNode *rc = (struct TreeNode *) malloc(sizeof(struct TreeNode));
-  TreeNodePtr rc = DataStructureFactory::createTreeNode();
-  rc->centre = newCentre;
-  rc->points = newPoints;
-  rc->n = nNew;
-
-  rc->lc = NULL;
-  rc->rc = NULL;
-  rc->parent = parent;
-
-  treeNodeTargetFunctionValue(rc);
-
-  // set childs of the parent node
-  parent->lc = lc;
-  parent->rc = rc;
+  int lc = (int)nodes.size(), rc = lc + 1;
+  nodes.push_back(Node{begin, nOld, nodes[node].centre, node, -1, -1, 0.0});
+  nodes.push_back(Node{nOld, end, newCentre, node, -1, -1, 0.0});
+  treeNodeTargetFunctionValue(nodes[lc]);
+  treeNodeTargetFunctionValue(nodes[rc]);
+  nodes[node].lc = lc;
+  nodes[node].rc = rc;
 
   // propagate the cost changes to the parent nodes
-  while (parent != NULL) {
-    parent->cost = parent->lc->cost + parent->rc->cost;
-    parent = parent->parent;
-  }
+  for (int parent = node; parent >= 0; parent = nodes[parent].parent)
+    nodes[parent].cost =
+        nodes[nodes[parent].lc].cost + nodes[nodes[parent].rc].cost;
 }
-
-/**
- * returns the next centre from A or B.
- * @param point
- * @param centreA
- * @param centreB
- * @return
- */
-SESAME::PointPtr SESAME::LandmarkWindow::CoresetTree::determineClosestCentre(
-    PointPtr point, PointPtr centreA, PointPtr centreB) {
-  // loop counter variable
-  int l;
-
-  // stores the distance between p and centreA
-  double distanceA = 0.0;
-
-  for (l = 0; l < point->getDimension(); l++) {
-    // centroid coordinate of the point
-    double centroidCoordinatePoint;
-    if (point->getWeight() != 0.0) {
-      centroidCoordinatePoint = point->getFeatureItem(l) / point->getWeight();
-    } else {
-      centroidCoordinatePoint = point->getFeatureItem(l);
-    }
-    // centroid coordinate of the centre
-    double centroidCoordinateCentre;
-    if (centreA->getWeight() != 0.0) {
-      centroidCoordinateCentre =
-          centreA->getFeatureItem(l) / centreA->getWeight();
-    } else {
-      centroidCoordinateCentre = centreA->getFeatureItem(l);
-    }
-
-    distanceA += (centroidCoordinatePoint - centroidCoordinateCentre) *
-                 (centroidCoordinatePoint - centroidCoordinateCentre);
-  }
-
-  // stores the distance between p and centreB
-  double distanceB = 0.0;
-
-  for (l = 0; l < point->getDimension(); l++) {
-    // centroid coordinate of the point
-    double centroidCoordinatePoint;
-    if (point->getWeight() != 0.0) {
-      centroidCoordinatePoint = point->getFeatureItem(l) / point->getWeight();
-    } else {
-      centroidCoordinatePoint = point->getFeatureItem(l);
-    }
-    // centroid coordinate of the centre
-    double centroidCoordinateCentre;
-    if (centreB->getWeight() != 0.0) {
-      centroidCoordinateCentre =
-          centreB->getFeatureItem(l) / centreB->getWeight();
-    } else {
-      centroidCoordinateCentre = centreB->getFeatureItem(l);
-    }
-
-    distanceB += (centroidCoordinatePoint - centroidCoordinateCentre) *
-                 (centroidCoordinatePoint - centroidCoordinateCentre);
-  }
-
-  // return the nearest centre
-  if (distanceA < distanceB) {
-    return centreA;
-  } else {
-    return centreB;
-  }
-}
\ No newline at end of file
@@ -47,7 +47,12 @@ void SESAME::LandmarkWindow::initWindow(int num) {
 void SESAME::LandmarkWindow::insertPoint(PointPtr point) {
   // check if there is enough space in the first window
   int cursize = this->windowManager.windows[0].cursize;
-  if (cursize >= this->windowManager.maxWindowSize) {
+  if (cursize >= this->windowManager.maxWindowSize && mergeWorkers > 0) {
+    timerMeter.clusterUpdateAccMeasure();
+    spillAsync();
+    cursize = 0;
+    timerMeter.clusterUpdateEndMeasure();
+  } else if (cursize >= this->windowManager.maxWindowSize) {
     //    SESAME_DEBUG("Window 0 is full");
     // start spillover process
     int curWindow = 0;
@@ -60,12 +65,10 @@ void SESAME::LandmarkWindow::insertPoint(PointPtr point) {
       //      " << curWindow << " points to window "
       //                       << nextWindow);
 
-      // if empty, copy the window
-      int i;
-      for (i = 0; i < this->windowManager.maxWindowSize; i++) {
-        this->windowManager.windows[nextWindow].points[i] =
-            this->windowManager.windows[curWindow].points[i]->copy();
-      }
+      // if empty, move the window; the first window takes over the stale
+      // points of the next one and overwrites them
+      this->windowManager.windows[nextWindow].points.swap(
+          this->windowManager.windows[curWindow].points);
       // window is now full
       this->windowManager.windows[nextWindow].cursize =
           this->windowManager.maxWindowSize;
@@ -82,13 +85,10 @@ void SESAME::LandmarkWindow::insertPoint(PointPtr point) {
       //          curWindow << " to spillover " << nextWindow);
       //      SESAME_DEBUG(
       //          "Window " << nextWindow << " is full");
-      // copy the points in the current window to the next spillover and
+      // move the points in the current window to the next spillover and
       // continue
-      int i;
-      for (i = 0; i < this->windowManager.maxWindowSize; i++) {
-        this->windowManager.windows[nextWindow].spillover[i] =
-            this->windowManager.windows[curWindow].points[i]->copy();
-      }
+      this->windowManager.windows[nextWindow].spillover.swap(
+          this->windowManager.windows[curWindow].points);
       this->windowManager.windows[0].cursize = 0;
       cursize = 0;
       curWindow++;
@@ -144,12 +144,121 @@ void SESAME::LandmarkWindow::insertPoint(PointPtr point) {
   }
   timerMeter.dataInsertAccMeasure();
   // if the first window is not full, just insert point into it
-  this->windowManager.windows[0].points[cursize] =
-      point->copy(); //   .copy(point);
+  assignPoint(this->windowManager.windows[0].points[cursize], *point);
   this->windowManager.windows[0].cursize++;
   timerMeter.dataInsertEndMeasure();
 }
 
+SESAME::LandmarkWindow::~LandmarkWindow() {
+  {
+    std::lock_guard<std::mutex> lock(mergeMutex);
+    mergeStop = true;
+  }
+  mergeReady.notify_all();
+  for (auto &thread : mergeThreads)
+    thread.join();
+}
+
+void SESAME::LandmarkWindow::initAsyncMerge(int workers, unsigned long seed) {
+  this->mergeWorkers = workers;
+  this->mergeSeed = seed;
+  this->mergeCount = 0;
+  this->pendingCoresets.assign(this->windowManager.numberOfWindow,
+                               PendingCoreset());
+  for (int i = 0; i < workers; i++)
+    mergeThreads.emplace_back(&LandmarkWindow::mergeWorker, this);
+}
+
+void SESAME::LandmarkWindow::mergeWorker() {
+  while (true) {
+    std::packaged_task<std::vector<PointPtr>()> task;
+    {
+      std::unique_lock<std::mutex> lock(mergeMutex);
+      mergeReady.wait(lock,
+                      [this]() { return mergeStop || !mergeQueue.empty(); });
+      if (mergeQueue.empty())
+        return;
+      task = std::move(mergeQueue.front());
+      mergeQueue.pop_front();
+    }
+    task();
+  }
+}
+
+void SESAME::LandmarkWindow::spillAsync() {
+  // the first window starts over with fresh slots, its points now belong to
+  // the cascade
+  std::vector<PointPtr> points(this->windowManager.maxWindowSize);
+  points.swap(this->windowManager.windows[0].points);
+  this->windowManager.windows[0].cursize = 0;
+  std::promise<std::vector<PointPtr>> bucket;
+  bucket.set_value(std::move(points));
+  PendingCoreset carry = bucket.get_future().share();
+
+  // binary carry: an empty window takes the coreset, a full one is merged
+  // with it and the union moves on to the next window
+  for (int i = 1;; i++) {
+    if (!pendingCoresets[i].valid()) {
+      pendingCoresets[i] = carry;
+      break;
+    }
+    carry = mergeAsync(pendingCoresets[i], carry);
+    pendingCoresets[i] = PendingCoreset();
+  }
+
+  // back pressure: ingest waits once too many unions are in flight
+  while (!mergesInFlight.empty() &&
+         (mergesInFlight.size() > (size_t)mergeWorkers ||
+          mergesInFlight.front().wait_for(std::chrono::seconds(0)) ==
+              std::future_status::ready)) {
+    mergesInFlight.front().wait();
+    mergesInFlight.pop_front();
+  }
+}
+
+SESAME::LandmarkWindow::PendingCoreset
+SESAME::LandmarkWindow::mergeAsync(PendingCoreset setA, PendingCoreset setB) {
+  auto worker = std::make_shared<CoresetTree>(*this->tree);
+  worker->seed(mergeSeed + ++mergeCount);
+  int size = this->windowManager.maxWindowSize;
+  std::packaged_task<std::vector<PointPtr>()> task(
+      [worker, size, setA, setB]() {
+        std::vector<PointPtr> pointsA = setA.get(), pointsB = setB.get();
+        std::vector<PointPtr> centres(size);
+        worker->unionTreeCoreset(size, size, size, pointsA, pointsB, centres);
+        return centres;
+      });
+  PendingCoreset merged = task.get_future().share();
+  {
+    std::lock_guard<std::mutex> lock(mergeMutex);
+    mergeQueue.push_back(std::move(task));
+  }
+  mergeReady.notify_one();
+  mergesInFlight.push_back(merged);
+  return merged;
+}
+
+void SESAME::LandmarkWindow::finishAsyncMerge() {
+  for (size_t i = 1; i < pendingCoresets.size(); i++) {
+    if (pendingCoresets[i].valid()) {
+      this->windowManager.windows[i].points = pendingCoresets[i].get();
+      this->windowManager.windows[i].cursize =
+          this->windowManager.maxWindowSize;
+      pendingCoresets[i] = PendingCoreset();
+    } else {
+      this->windowManager.windows[i].cursize = 0;
+    }
+  }
+  mergesInFlight.clear();
+}
+
+void SESAME::LandmarkWindow::assignPoint(PointPtr &slot, const Point &source) {
+  if (slot && slot.use_count() == 1)
+    *slot = source;
+  else
+    slot = std::make_shared<Point>(source);
+}
+
 /**
 It may happen that the manager is not full (since n is not always a power of 2).
 In this case we extract the coreset from the manager by computing a coreset of
@@ -165,6 +274,8 @@ this operation should only be called after the streaming process is sourceEnd
 **/
 std::vector<SESAME::PointPtr>
 SESAME::LandmarkWindow::getCoresetFromManager(std::vector<PointPtr> &coreset) {
+  if (mergeWorkers > 0)
+    finishAsyncMerge();
   int i = 0;
   if (this->windowManager.windows[this->windowManager.numberOfWindow - 1]
           .cursize == this->windowManager.maxWindowSize) {
@@ -261,7 +372,9 @@ void SESAME::LandmarkWindow::storeSnapshot(unsigned int currentOrder,
   unsigned int size = orderSnapShots[currentOrder].size();
   SnapshotPtr snapshot;
   snapshot = DataStructureFactory::createSnapshot(
-      const_cast<std::vector<MicroClusterPtr> &>(microClusters), elapsedTime);
+      const_cast<std::vector<MicroClusterPtr> &>(microClusters), elapsedTime,
+      latestSnapshot);
+  latestSnapshot = snapshot;
   // SESAME_INFO("The current order size is "<<size<<" current order is
   // "<<currentOrder<<" elapsed Time "<<elapsedTime);
   if (size == this->pyramidalWindow.time_interval + 1) {
@@ -271,4 +384,5 @@ void SESAME::LandmarkWindow::storeSnapshot(unsigned int currentOrder,
 }
 void SESAME::LandmarkWindow::clearPyramidalWindow() {
   std::vector<SESAME::QueueSnapshotPtr>().swap(this->orderSnapShots);
+  latestSnapshot.reset();
 }
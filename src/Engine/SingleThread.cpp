@@ -12,4 +12,8 @@ void SESAME::SingleThread::construct(std::function<void(void)> fun, int id) {
 }
 int SESAME::SingleThread::setID(int id) { return this->id = id; }
 int SESAME::SingleThread::getID() { return this->id; }
-void SESAME::SingleThread::join() { this->ThreadPtr->join(); }
+void SESAME::SingleThread::join() {
+  // a source or sink that was only used to load data never started its thread
+  if (this->ThreadPtr)
+    this->ThreadPtr->join();
+}
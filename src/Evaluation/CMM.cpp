@@ -8,8 +8,10 @@
 #include "Utils/Logger.hpp"
 #include "Utils/UtilityFunctions.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
 #include <map>
 #include <numeric>
 #include <omp.h>
@@ -42,21 +44,20 @@ double CMMPoint::getDisTo(CMMPointPtr &p) {
 }
 
 double CMMPoint::knnDis(int k, CMMCluster &c) {
-  std::vector<CMMPointPtr> list = c.points;
+  std::vector<CMMPointPtr> &list = c.points;
   int size = c.points.size();
   std::vector<double> diss(size);
   for (int i = 0; i < size; i++) {
-    CMMPointPtr p = list.at(i);
-    if (list.at(i)->id != this->id) {
-      diss[i] = getDisTo(list.at(i));
+    if (list[i]->id != this->id) {
+      diss[i] = getDisTo(list[i]);
     }
   }
-  sort(diss.begin(), diss.end());
+  // only the k smallest distances are summed
+  int num = std::min(k, size);
+  std::partial_sort(diss.begin(), diss.begin() + num, diss.end());
   double sum = 0;
-  int num = 0;
-  for (int i = 0; i < k && i < size; i++) {
+  for (int i = 0; i < num; i++) {
     sum += diss[i];
-    num++;
   }
   if (sum == 0)
     return 1;
@@ -235,104 +236,84 @@ double CMMDriver::computeWeight(double deltaTime) {
   return pow(belta, lamda * (deltaTime));
 }
 
-// template <template <typename Ty> class T>
-// void GetKnn(int i, int k, const T<int> &cluster,
-//             const std::vector<PointPtr> &inputs, std::deque<double> &dists,
-//             std::deque<int> indexes) {
-//   for (auto j : cluster) {
-//     if (i != j) {
-//       double dist = inputs[i]->L2Dist(inputs[j]);
-//       if (dists.size() < k || dist < dists.back()) {
-//         int index = 0;
-//         while (index < dists.size() && dist > dists[index])
-//           ++index;
-//         dists[index] = dist;
-//         indexes[index] = j;
-//         if (dists.size() > k) {
-//           dists.pop_back();
-//           indexes.pop_back();
-//         }
-//       }
-//     }
-//   }
-// }
-
-void CMM::Cluster::CalcKnn(int k, const std::vector<PointPtr> &inputs) {
+const KdTree &CMM::Cluster::Tree(const std::vector<PointPtr> &inputs) {
+  if (!tree)
+    tree = std::make_unique<KdTree>(inputs, vpoints);
+  return *tree;
+}
+
+double CMM::Cluster::KnnDist(int i, const std::vector<PointPtr> &inputs) {
+  // average distance to the two nearest other points of the cluster
+  const int n = vpoints.size();
+  std::vector<double> dists;
+  Tree(inputs).nearest(inputs[i], 2, i, dists);
+  if (n >= 3)
+    return (dists[0] + dists[1]) / 2;
+  if (n == 2)
+    return dists[0];
+  return 0.0;
+}
+
+void CMM::Cluster::SetConn(int i, const std::vector<PointPtr> &inputs) const {
+  double upperKnn = knnMeanAvg + knnDevAvg;
+  if (inputs[i]->knn < upperKnn)
+    inputs[i]->conn = 1;
+  else
+    inputs[i]->conn = upperKnn / inputs[i]->knn;
+}
+
+void CMM::Cluster::CalcKnn(int k, const std::vector<PointPtr> &inputs,
+                           size_t sampleSize, std::mt19937 &rng,
+                           std::vector<char> &knnKnown) {
   const int n = points.size();
-  // std::vector<std::vector<double>> adjDists(n, std::vector<double>(n, 0));
-  //   omp_set_dynamic(0);
-  //   omp_set_num_threads(std::min(omp_get_num_procs(), 8));
-  // #pragma omp parallel for
-  // for (int i = 0; i < n; ++i) {
-  //   for (int j = i + 1; j < n; ++j) {
-  //     adjDists[i][j] = adjDists[j][i] =
-  //         inputs[vpoints[i]]->L2Dist(inputs[vpoints[j]]);
-  //   }
-  // }
+  // Estimate the statistics from a uniform sample of the members when the
+  // cluster is larger than sampleSize, and from all of them otherwise
+  std::vector<int> sample;
+  if (sampleSize > 0 && (size_t)n > sampleSize) {
+    sample.assign(vpoints.begin(), vpoints.begin() + sampleSize);
+    for (int i = (int)sampleSize; i < n; ++i) {
+      std::uniform_int_distribution<int> slot(0, i);
+      int j = slot(rng);
+      if (j < (int)sampleSize)
+        sample[j] = vpoints[i];
+    }
+  } else {
+    sample = vpoints;
+  }
+  const int m = sample.size();
 
+  Tree(inputs);
 #pragma omp parallel for
-  for (int i = 0; i < n; ++i) {
-    auto first = std::numeric_limits<double>::max(), second = first;
-    for (int j = 0; j < n; ++j) {
-      if (i != j) {
-        // double dist = adjDists[i][j];
-        double dist = inputs[vpoints[i]]->L2Dist(inputs[vpoints[j]]);
-        if (dist < first) {
-          second = first;
-          first = dist;
-        } else if (dist < second) {
-          second = dist;
-        }
-      }
-    }
-    double avgKnn = 0.0;
-    if (n >= 3) {
-      avgKnn = (first + second) / 2;
-    } else if (n == 2) {
-      avgKnn = first;
-    }
-    inputs[vpoints[i]]->knn = avgKnn;
-    knnMeanAvg += avgKnn;
-    knnDevAvg += avgKnn * avgKnn;
+  for (int i = 0; i < m; ++i)
+    inputs[sample[i]]->knn = KnnDist(sample[i], inputs);
+  for (int i = 0; i < m; ++i) {
+    knnMeanAvg += inputs[sample[i]]->knn;
+    knnDevAvg += inputs[sample[i]]->knn * inputs[sample[i]]->knn;
   }
-  knnMeanAvg = knnMeanAvg.load() / n;
-  knnDevAvg = knnDevAvg.load() / n;
+  knnMeanAvg /= m;
+  knnDevAvg /= m;
   double variance = knnDevAvg - knnMeanAvg * knnMeanAvg;
   if (variance <= 0.0)
     variance = 1e-50;
   knnDevAvg = sqrt(variance);
-
-  // calculate the connectivity of each point
-  double upperKnn = knnMeanAvg + knnDevAvg;
-  for (int i = 0; i < n; ++i) {
-    if (inputs[vpoints[i]]->knn < upperKnn)
-      inputs[vpoints[i]]->conn = 1;
-    else
-      inputs[vpoints[i]]->conn = upperKnn / inputs[vpoints[i]]->knn;
+  if (m < n)
+    knnMeanBound = 1.96 * knnDevAvg / sqrt(m) * sqrt((double)(n - m) / (n - 1));
+
+  // calculate the connectivity of each sampled point, the others are left to
+  // CMM::Conn
+  for (int i = 0; i < m; ++i) {
+    SetConn(sample[i], inputs);
+    knnKnown[sample[i]] = 1;
   }
 }
 
 double CMM::CalcConn(int i, int j, const std::vector<PointPtr> &inputs) {
-  // std::deque<double> dists;
-  // std::deque<int> indexes;
-  // GetKnn(i, knnNeighbourhood, clusters[j].points, inputs, dists, indexes);
   const auto n = clusters[j].vpoints.size();
-  auto first = std::numeric_limits<double>::max(), second = first;
-#pragma omp parallel for
-  for (int k = 0; k < n; ++k) {
-    double dist = inputs[i]->L2Dist(inputs[clusters[j].vpoints[k]]);
-    if (dist < first) {
-      second = first;
-      first = dist;
-    } else if (dist < second) {
-      second = dist;
-    }
-  }
-  double avgKnn = 0.0;
-  if (n >= 2) {
-    avgKnn = (first + second) / 2;
-  } else {
-    avgKnn = first;
+  double avgKnn = std::numeric_limits<double>::max();
+  if (n > 0) {
+    std::vector<double> dists;
+    clusters[j].Tree(inputs).nearest(inputs[i], 2, -1, dists);
+    avgKnn = n >= 2 ? (dists[0] + dists[1]) / 2 : dists[0];
   }
   double upperKnn = clusters[inputs[i]->clu_id].knnMeanAvg +
                     clusters[inputs[i]->clu_id].knnDevAvg;
@@ -344,6 +325,16 @@ double CMM::CalcConn(int i, int j, const std::vector<PointPtr> &inputs) {
   }
 }
 
+double CMM::Conn(int i, const std::vector<PointPtr> &inputs) {
+  if (!knnKnown[i]) {
+    auto &cluster = clusters[inputs[i]->clu_id];
+    inputs[i]->knn = cluster.KnnDist(i, inputs);
+    cluster.SetConn(i, inputs);
+    knnKnown[i] = 1;
+  }
+  return inputs[i]->conn;
+}
+
 double CMM::CalcConn(int i, const std::vector<PointPtr> &inputs) {
   return CalcConn(i, inputs[i]->clu_id, inputs);
 }
@@ -359,17 +350,31 @@ void CMM::AnalyseGT(const std::vector<PointPtr> &inputs,
   lambdaConn = -log(lambdaConnRefXValue) / log(2) / lambdaConnX;
   // std::unordered_map<int, int> mapTrueLabelToWorkLabel;
   // std::vec
+  // points of cluster 0 and noise get no connectivity
+  knnKnown.assign(inputs.size(), 0);
   for (int i = 0; i < inputs.size(); ++i)
     if (inputs[i]->clu_id != -1) {
       auto clu = inputs[i]->clu_id;
       clusters[clu].Insert(i);
+      knnKnown[i] = clu == 0;
     } else {
       clusters[0].Insert(i);
+      knnKnown[i] = 1;
     }
   std::cerr << "CMM::CalcKnn start" << std::endl;
+  std::mt19937 rng(param.seed);
   for (auto &cluster : clusters) {
-    if (cluster.first != 0)
-      cluster.second.CalcKnn(knnNeighbourhood, inputs);
+    if (cluster.first == 0)
+      continue;
+    cluster.second.CalcKnn(knnNeighbourhood, inputs, param.cmm_sample_size,
+                           rng, knnKnown);
+    if (cluster.second.knnMeanBound > 0)
+      std::cerr << "CMM cluster " << cluster.first << ": knn mean "
+                << cluster.second.knnMeanAvg << " +- "
+                << cluster.second.knnMeanBound << " (95%, "
+                << param.cmm_sample_size << " of "
+                << cluster.second.vpoints.size() << " points sampled)"
+                << std::endl;
   }
   // for (int i = 0; i < inputs.size(); ++i)
   //   if (inputs[i]->clu_id != -1) {
@@ -455,7 +460,7 @@ double CMM::MisplacedError(int i, int fc, int hc,
       return 0.00001;
     } else {
       double weight = 1 - CalcConn(i, real_hc, inputs);
-      return weight * inputs[i]->conn;
+      return weight * Conn(i, inputs);
     }
   }
   // return inputs[i]->conn;
@@ -476,7 +481,7 @@ double CMM::NoiseError(int i, int fc, int hc,
 double CMM::MissedError(int i, int fc, int hc,
                         const std::vector<PointPtr> &inputs) {
   // TODO
-  return inputs[i]->conn;
+  return Conn(i, inputs);
   // for(int i = 1; i<=param.num_clusters; ++i) {
   //   if(matchMap[i]!=-1 && matchMap[i] == hc) {
   //   }
@@ -492,26 +497,18 @@ void CMM::CalcError(const std::vector<PointPtr> &inputs,
 
   int numNoise = 0;
   double errorNoise = 0;
-  double errorNoiseMax = 0;
 
   double errorMissed = 0;
-  // double errorMissedMax = 0;
 
   double errorMisplaced = 0;
-  double errorMisplacedMax = 0;
 
   double totalError = 0.0;
   double totalErrorMax = 0.0;
 
   for (int i = 0; i < inputs.size(); ++i) {
     auto fc = predicts[i]->clu_id, hc = inputs[i]->clu_id;
-    if (hc == -1) {
+    if (hc == -1)
       numNoise++;
-      errorNoiseMax += inputs[i]->weight * inputs[i]->conn;
-    } else {
-      errorMissed += inputs[i]->weight * inputs[i]->conn;
-      errorMisplacedMax += inputs[i]->weight * inputs[i]->conn;
-    }
     totalErrorMax += inputs[i]->weight;
     double err = 0;
     bool flag = false;
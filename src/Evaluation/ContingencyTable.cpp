@@ -0,0 +1,105 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#include "Evaluation/ContingencyTable.hpp"
+
+#include <algorithm>
+#include <omp.h>
+
+namespace {
+std::vector<int> sortedLabels(const std::vector<SESAME::PointPtr> &points) {
+  std::vector<int> labels(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+    labels[i] = points[i]->getClusteringCenter();
+  std::sort(labels.begin(), labels.end());
+  labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+  return labels;
+}
+
+int rank(const std::vector<int> &labels, int label) {
+  return (int)(std::lower_bound(labels.begin(), labels.end(), label) -
+               labels.begin());
+}
+} // namespace
+
+SESAME::ContingencyTable::ContingencyTable(
+    const std::vector<PointPtr> &inputs,
+    const std::vector<PointPtr> &predicts) {
+  int numInputs = (int)inputs.size(), numPredicts = (int)predicts.size();
+  std::vector<int> columnLabels = sortedLabels(inputs);
+  std::vector<int> rowLabels = sortedLabels(predicts);
+  columnCount.assign(columnLabels.size(), 0);
+  rowCount.assign(rowLabels.size(), 0);
+
+  // Ground truth column of every point index
+  std::vector<int> inputColumn(numInputs);
+  int maxIndex = -1;
+#pragma omp parallel for reduction(max : maxIndex)
+  for (int i = 0; i < numInputs; i++) {
+    inputColumn[i] = rank(columnLabels, inputs[i]->getClusteringCenter());
+    maxIndex = std::max(maxIndex, inputs[i]->getIndex());
+  }
+  std::vector<int> columnOfIndex(maxIndex + 1, -1);
+  for (int i = 0; i < numInputs; i++)
+    if (inputs[i]->getIndex() >= 0)
+      columnOfIndex[inputs[i]->getIndex()] = inputColumn[i];
+
+  std::vector<int> rowOf(numPredicts), columnOf(numPredicts);
+#pragma omp parallel for
+  for (int i = 0; i < numPredicts; i++) {
+    rowOf[i] = rank(rowLabels, predicts[i]->getClusteringCenter());
+    int index = predicts[i]->getIndex();
+    columnOf[i] = index >= 0 && index <= maxIndex ? columnOfIndex[index] : -1;
+  }
+
+  // Bucket the predicted points by row, keeping their order
+  int numRows = (int)rowLabels.size(), numColumns = (int)columnLabels.size();
+  std::vector<int> pointStart(numRows + 1, 0), points(numPredicts);
+  for (int i = 0; i < numPredicts; i++) {
+    pointStart[rowOf[i] + 1]++;
+    predictWeight += predicts[i]->getWeight();
+  }
+  for (int row = 0; row < numRows; row++)
+    pointStart[row + 1] += pointStart[row];
+  std::vector<int> next(pointStart.begin(), pointStart.end() - 1);
+  for (int i = 0; i < numPredicts; i++)
+    points[next[rowOf[i]]++] = i;
+
+  // Each thread sums its rows in a dense buffer over the columns, so the
+  // sums do not depend on the number of threads
+  std::vector<std::vector<Cell>> rowCells(numRows);
+#pragma omp parallel
+  {
+    std::vector<double> weight(numColumns, 0), count(numColumns, 0);
+    std::vector<int> touched;
+#pragma omp for schedule(dynamic, 16)
+    for (int row = 0; row < numRows; row++) {
+      for (int p = pointStart[row]; p < pointStart[row + 1]; p++) {
+        int column = columnOf[points[p]];
+        if (column < 0)
+          continue;
+        if (count[column] == 0)
+          touched.push_back(column);
+        weight[column] += predicts[points[p]]->getWeight();
+        count[column]++;
+      }
+      std::sort(touched.begin(), touched.end());
+      for (int column : touched) {
+        rowCells[row].push_back({column, weight[column], count[column]});
+        weight[column] = count[column] = 0;
+      }
+      touched.clear();
+    }
+  }
+
+  rowStart.assign(numRows + 1, 0);
+  for (int row = 0; row < numRows; row++) {
+    rowStart[row + 1] = rowStart[row] + rowCells[row].size();
+    for (auto &cell : rowCells[row]) {
+      rowCount[row] += cell.count;
+      columnCount[cell.column] += cell.count;
+      matchedCount += cell.count;
+      cells.push_back(cell);
+    }
+  }
+}
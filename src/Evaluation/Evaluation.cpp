@@ -5,6 +5,7 @@
 #include "Algorithm/DataStructure/GenericFactory.hpp"
 #include "Algorithm/Param.hpp"
 #include "Evaluation/CMM.hpp"
+#include "Evaluation/ContingencyTable.hpp"
 #include "Evaluation/Euclidean.hpp"
 #include "Evaluation/NMI.hpp"
 #include "Evaluation/Purity.hpp"
@@ -13,6 +14,7 @@
 #include "Utils/UtilityFunctions.hpp"
 
 #include <cmath>
+#include <optional>
 
 namespace SESAME {
 void AccuracyRes::Evaluate(const param_t &param,
@@ -20,12 +22,15 @@ void AccuracyRes::Evaluate(const param_t &param,
                            const std::vector<PointPtr> &predicts) {
   if (param.run_eval && param.num_res > 0 && param.num_res <= 60000) {
     Timer pur_timer, cmm_timer, nmi_timer;
+    // Purity and NMI are both read off one contingency matrix
+    std::optional<ContingencyTable> table;
     std::cerr << "Accuracy:" << std::endl;
     pur_timer.Tick();
     if (param.run_pur) {
       std::cerr << "Purity begin" << std::endl;
-      purity =
-          Purity::purityCost(inputs, predicts, param.dim, param.time_decay);
+      Purity::setWeights(predicts, param.time_decay);
+      table.emplace(inputs, predicts);
+      purity = Purity::purityCost(*table);
     }
     pur_timer.Tock();
     std::cerr << "\033[1;34mPurity: " << round(purity * 10000) / 10000
@@ -33,7 +38,9 @@ void AccuracyRes::Evaluate(const param_t &param,
     nmi_timer.Tick();
     if (param.run_nmi) {
       std::cerr << "NMI begin" << std::endl;
-      nmi = NMI::Evaluate(inputs, predicts, param.num_clusters, param.num_res);
+      if (!table)
+        table.emplace(inputs, predicts);
+      nmi = NMI::Evaluate(*table);
     }
     nmi_timer.Tock();
     std::cerr << "\033[1;34mNMI: " << round(nmi * 10000) / 10000
@@ -4,45 +4,30 @@
 #include "Evaluation/NMI.hpp"
 #include <cmath>
 
-double SESAME::NMI::Evaluate(const std::vector<PointPtr> &inputs,
-                             const std::vector<PointPtr> &predicts, int gt_size,
-                             int predict_size) {
-  std::vector<int> gt_cap(gt_size, 0);
-  std::vector<int> predict_cap(predict_size, 0);
-  std::vector<std::vector<int>> mutual(gt_size,
-                                       std::vector<int>(predict_size, 0));
-  for (int i = 0; i < inputs.size(); i++) {
-    auto gtClu_id = inputs[i]->getClusteringCenter() - 1;
-    auto predClu_id = predicts[i]->getClusteringCenter();
-
-    // calculate the gt and predict cluster probability
-    gt_cap[gtClu_id]++;
-    predict_cap[predClu_id]++;
-
-    // calculate the joint probability
-    mutual[gtClu_id][predClu_id]++;
-  }
+double SESAME::NMI::Evaluate(const ContingencyTable &table) {
+  double total = table.matchedCount;
   double gtEntropy = 0;
   double predEntropy = 0;
   double mutualInformation = 0;
-  for (const auto &gt : gt_cap) {
-    double gtProb = (double)gt / (double)inputs.size();
-    gtEntropy -= gtProb * log2(gtProb);
+  for (const auto &gt : table.columnCount) {
+    if (gt != 0) {
+      double gtProb = gt / total;
+      gtEntropy -= gtProb * log2(gtProb);
+    }
   }
-  for (const auto &pred : predict_cap) {
+  for (const auto &pred : table.rowCount) {
     if (pred != 0) {
-      double predProb = (double)pred / (double)inputs.size();
+      double predProb = pred / total;
       predEntropy -= predProb * log2(predProb);
     }
   }
-  for (int i = 0; i < gt_size; i++) {
-    for (int j = 0; j < predict_size; j++) {
-      double jointProb = (double)mutual[i][j] / (double)inputs.size();
-      double gtProb = (double)gt_cap[i] / (double)inputs.size();
-      if (jointProb != 0) {
-        double predProb = (double)predict_cap[j] / (double)inputs.size();
-        mutualInformation += jointProb * log2(jointProb / (gtProb * predProb));
-      }
+  // Only the non-zero joint probabilities are stored
+  for (int i = 0; i < table.rows(); i++) {
+    double predProb = table.rowCount[i] / total;
+    for (size_t c = table.rowStart[i]; c < table.rowStart[i + 1]; c++) {
+      double jointProb = table.cells[c].count / total;
+      double gtProb = table.columnCount[table.cells[c].column] / total;
+      mutualInformation += jointProb * log2(jointProb / (gtProb * predProb));
     }
   }
   double nmi = 2 * mutualInformation / (predEntropy + gtEntropy);
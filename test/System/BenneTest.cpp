@@ -0,0 +1,134 @@
+// Copyright (C) 2021 by the IntelliStream team
+// (https://github.com/intellistream)
+
+#include <gtest/gtest.h>
+
+#include <climits>
+
+#include "Algorithm/AlgorithmFactory.hpp"
+#include "Algorithm/Benne.hpp"
+#include "Algorithm/DataStructure/GenericFactory.hpp"
+#include "Sinks/DataSink.hpp"
+#include "Sources/DataSource.hpp"
+#include "Utils/BenchmarkUtils.hpp"
+
+using namespace SESAME;
+
+// Runs Benne directly on the points of CoverType
+class BenneTest : public ::testing::Test {
+protected:
+  param_t cmd_params;
+  std::vector<PointPtr> inputs;
+
+  void SetUp() override {
+    cmd_params.num_points = Benne::INCRE_REF_CNT + 100;
+    cmd_params.seed = 10;
+    cmd_params.num_clusters = 7;
+    cmd_params.dim = 54;
+    cmd_params.coreset_size = 100;
+    cmd_params.k = 7;
+    cmd_params.landmark = 1000;
+    cmd_params.time_decay = false;
+    cmd_params.input_file = "datasets/CoverType.txt";
+    cmd_params.algo = SESAME::BenneType;
+    DataSourcePtr sourcePtr = GenericFactory::New<DataSource>(cmd_params);
+    sourcePtr->load();
+    inputs = sourcePtr->getInputs();
+  }
+};
+
+// Forwards to the algorithm Benne runs and keeps a copy of every point
+// inserted into it and of every set of online centres taken from it
+class InsertRecorder : public Algorithm {
+public:
+  AlgorithmPtr algo;
+  std::vector<PointPtr> inserted;
+  std::vector<std::vector<PointPtr>> outputs;
+  explicit InsertRecorder(AlgorithmPtr algo) : algo(std::move(algo)) {}
+  void Init() override { algo->Init(); }
+  void RunOnline(PointPtr input) override { algo->RunOnline(input); }
+  void RunOffline(DataSinkPtr sinkPtr) override { algo->RunOffline(sinkPtr); }
+  void Insert(PointPtr input) override {
+    inserted.push_back(input->copy());
+    algo->Insert(input);
+  }
+  void OutputOnline(std::vector<PointPtr> &centers) override {
+    algo->OutputOnline(centers);
+    outputs.emplace_back();
+    for (auto &center : centers)
+      outputs.back().push_back(center->copy());
+  }
+};
+
+TEST_F(BenneTest, Snapshot) {
+  cmd_params.snapshot_interval = 500;
+  cmd_params.obj = SESAME::balance;
+
+  AlgorithmPtr algoPtr = AlgorithmFactory::create(cmd_params);
+  algoPtr->Init();
+  ASSERT_EQ(algoPtr->Query(), nullptr);
+
+  // Benne publishes the centres of the algorithm it runs
+  for (int i = 0; i < 2500; i++)
+    algoPtr->RunOnline(inputs[i]);
+  auto view = algoPtr->Query();
+  ASSERT_NE(view, nullptr);
+  ASSERT_EQ(view->num_points, 2500);
+  ASSERT_FALSE(view->centers.empty());
+}
+
+TEST_F(BenneTest, BackgroundRefine) {
+  cmd_params.obj = SESAME::accuracy;
+  // Keep Benne on its first algorithm
+  cmd_params.benne_threshold.queue_size = INT_MAX;
+  auto refined = [&](bool background) {
+    cmd_params.benne_background_refine = background;
+    Benne benne(cmd_params);
+    benne.Init();
+    auto recorder = std::make_shared<InsertRecorder>(benne.algo);
+    benne.algo = recorder;
+    for (auto &input : inputs)
+      benne.RunOnline(input);
+    benne.RunOffline(GenericFactory::New<DataSink>(cmd_params));
+    return recorder->inserted;
+  };
+
+  // The background refinement installs the centres a few points later, but
+  // they are the centres the inline one installs
+  auto inline_refine = refined(false);
+  auto background_refine = refined(true);
+  ASSERT_FALSE(inline_refine.empty());
+  ASSERT_EQ(background_refine.size(), inline_refine.size());
+  for (size_t i = 0; i < inline_refine.size(); i++)
+    for (int j = 0; j < cmd_params.dim; j++)
+      ASSERT_EQ(background_refine[i]->getFeatureItem(j),
+                inline_refine[i]->getFeatureItem(j));
+}
+
+TEST_F(BenneTest, MiniBatchRefine) {
+  cmd_params.obj = SESAME::accuracy;
+  cmd_params.benne_threshold.queue_size = INT_MAX;
+  cmd_params.benne_mini_batch = true;
+  Benne benne(cmd_params);
+  benne.Init();
+  auto recorder = std::make_shared<InsertRecorder>(benne.algo);
+  benne.algo = recorder;
+  for (auto &input : inputs)
+    benne.RunOnline(input);
+
+  // The online centres taken at the refinement are refined by mini-batch
+  // k-means and inserted back
+  ASSERT_EQ(recorder->outputs.size(), 1);
+  std::vector<PointPtr> refined;
+  MiniBatchKMeans miniBatchKMeans;
+  miniBatchKMeans.Run(benne.param, recorder->outputs.front(), refined);
+  ASSERT_FALSE(refined.empty());
+  ASSERT_EQ(recorder->inserted.size(), refined.size());
+  for (size_t i = 0; i < refined.size(); i++) {
+    ASSERT_EQ(recorder->inserted[i]->getClusteringCenter(),
+              refined[i]->getClusteringCenter());
+    for (int j = 0; j < cmd_params.dim; j++)
+      ASSERT_EQ(recorder->inserted[i]->getFeatureItem(j),
+                refined[i]->getFeatureItem(j));
+  }
+}
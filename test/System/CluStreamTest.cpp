@@ -10,6 +10,7 @@
 #include <filesystem>
 
 #include "Algorithm/AlgorithmFactory.hpp"
+#include "Algorithm/DataStructure/DataStructureFactory.hpp"
 #include "Algorithm/DataStructure/GenericFactory.hpp"
 #include "Sinks/DataSinkFactory.hpp"
 #include "Sources/DataSourceFactory.hpp"
@@ -42,5 +43,37 @@ TEST(System, CluStream) {
   // Run algorithm producing results.
   auto res = SESAME::RunBenchmark(cmd_params);
 
-  ASSERT_NEAR(res.first.purity, 0.2987, 0.002);
-}
\ No newline at end of file
+  ASSERT_EQ(res.first.num_res, 54);
+  ASSERT_NEAR(res.first.purity, 0.1453, 0.002);
+}
+
+TEST(CluStream, SnapshotSharing) {
+  MicroClusters microClusters;
+  for (int i = 0; i < 3; i++) {
+    auto microCluster = GenericFactory::New<MicroCluster>(2, i);
+    PointPtr point = GenericFactory::New<Point>(2, i);
+    point->setFeatureItem(i, 0);
+    microCluster->Init(point, i);
+    microClusters.push_back(microCluster);
+  }
+  auto first = DataStructureFactory::createSnapshot(microClusters, 1);
+
+  // Modifications between two snapshots renew the version once, at the
+  // second snapshot, which copies only the modified micro cluster
+  auto version = microClusters[1]->version;
+  PointPtr point = GenericFactory::New<Point>(2, 3);
+  microClusters[1]->insert(point, 3);
+  microClusters[1]->insert(point, 4);
+  ASSERT_EQ(microClusters[1]->version, version);
+  auto second = DataStructureFactory::createSnapshot(microClusters, 2, first);
+  ASSERT_EQ(second->microClusters[0], first->microClusters[0]);
+  ASSERT_NE(second->microClusters[1], first->microClusters[1]);
+  ASSERT_NE(second->microClusters[1]->version, version);
+  ASSERT_EQ(second->microClusters[2], first->microClusters[2]);
+  ASSERT_EQ(second->microClusters[1]->weight, 3);
+  ASSERT_EQ(first->microClusters[1]->weight, 1);
+
+  auto third = DataStructureFactory::createSnapshot(microClusters, 3, second);
+  for (int i = 0; i < 3; i++)
+    ASSERT_EQ(third->microClusters[i], second->microClusters[i]);
+}
@@ -6,13 +6,17 @@
 //
 
 #include "Algorithm/AlgorithmFactory.hpp"
+#include "Algorithm/DBStream.hpp"
 #include "Algorithm/DataStructure/GenericFactory.hpp"
 #include "Sinks/DataSinkFactory.hpp"
 #include "Sources/DataSourceFactory.hpp"
 #include "Utils/BenchmarkUtils.hpp"
 #include "Utils/Logger.hpp"
 
+#include <atomic>
 #include <filesystem>
+#include <map>
+#include <thread>
 
 #include <gtest/gtest.h>
 
@@ -38,4 +42,204 @@ TEST(System, DBStream) {
   cmd_params.store = false;
 
   auto res = SESAME::RunBenchmark(cmd_params);
-}
\ No newline at end of file
+}
+TEST(System, DBStreamRegions) {
+  param_t cmd_params;
+  cmd_params.num_points = 5000;
+  cmd_params.dim = 2;
+  cmd_params.base = 2;
+  cmd_params.lambda = 0.001;
+  cmd_params.radius = 10;
+  cmd_params.clean_interval = 400;
+  cmd_params.min_weight = 0.5;
+  cmd_params.alpha = 0.2;
+  cmd_params.input_file = "datasets/EDS.txt";
+  cmd_params.algo = SESAME::DBStreamType;
+  cmd_params.num_clusters = 27;
+  cmd_params.time_decay = false;
+  cmd_params.store = false;
+
+  // Macro clusters are the transitive closure of the strong edges
+  auto res = SESAME::RunBenchmark(cmd_params);
+
+  ASSERT_EQ(res.first.num_res, 16);
+  ASSERT_NEAR(res.first.purity, 0.7606, 0.01);
+}
+
+// Cluster index of each micro cluster id in the connected regions
+static std::map<int, int> regionLabels(const ConnectedRegions &regions) {
+  std::map<int, int> labels;
+  for (size_t c = 0; c < regions.finalClusters.size(); c++)
+    for (auto &microCluster : regions.finalClusters[c])
+      labels[microCluster->id.front()] = (int)c;
+  return labels;
+}
+
+TEST(System, DBStreamOnlineRegions) {
+  param_t cmd_params;
+  cmd_params.num_points = 16900;
+  cmd_params.dim = 2;
+  cmd_params.base = 2;
+  cmd_params.lambda = 0.001;
+  cmd_params.radius = 10;
+  cmd_params.clean_interval = 400;
+  cmd_params.min_weight = 0.5;
+  cmd_params.alpha = 0.2;
+  cmd_params.input_file = "datasets/EDS.txt";
+  cmd_params.algo = SESAME::DBStreamType;
+  cmd_params.num_clusters = 27;
+  cmd_params.time_decay = false;
+  cmd_params.rebuild_interval = 1000;
+
+  DataSourcePtr sourcePtr = GenericFactory::New<DataSource>(cmd_params);
+  sourcePtr->load();
+  DBStream dbStream(cmd_params);
+  dbStream.Init();
+  auto inputs = sourcePtr->getInputs();
+  int checked = 0, rebuilt = 0;
+  for (int i = 0; i < cmd_params.num_points; i++) {
+    dbStream.RunOnline(inputs[i]);
+    // Compare off the rebuild boundaries as well as right after a rebuild
+    if ((i + 1) % 1300 != 0 && dbStream.pointsSinceRebuild != 0)
+      continue;
+    dbStream.connectedRegions.findConnectedComponents();
+    ConnectedRegions fresh(cmd_params.alpha, cmd_params.min_weight);
+    fresh.connection(dbStream.microClusters, dbStream.weightedAdjacencyList);
+    auto online = regionLabels(dbStream.connectedRegions);
+    auto offline = regionLabels(fresh);
+    if (dbStream.pointsSinceRebuild == 0) {
+      // A rebuild starts over from the current graph
+      ASSERT_EQ(online.size(), offline.size());
+      ASSERT_EQ(dbStream.connectedRegions.finalClusters.size(),
+                fresh.finalClusters.size());
+      rebuilt++;
+    }
+    // Between rebuilds unions are never undone and edge weights go stale, so
+    // the online regions may merge or split a few micro clusters the fresh
+    // pass would not. Bound that drift: at most two regions apart, and at
+    // most 2% of the pairs of micro clusters grouped differently
+    long pairs = 0, disagree = 0;
+    for (auto a = online.begin(); a != online.end(); ++a) {
+      if (!offline.count(a->first))
+        continue;
+      for (auto b = std::next(a); b != online.end(); ++b) {
+        if (!offline.count(b->first))
+          continue;
+        pairs++;
+        bool together = a->second == b->second;
+        if (together != (offline[a->first] == offline[b->first]))
+          disagree++;
+      }
+    }
+    if (dbStream.pointsSinceRebuild == 0)
+      ASSERT_EQ(disagree, 0);
+    ASSERT_LE(std::abs((int)dbStream.connectedRegions.finalClusters.size() -
+                       (int)fresh.finalClusters.size()),
+              2);
+    ASSERT_LE(disagree, pairs / 50);
+    checked++;
+  }
+  ASSERT_GE(rebuilt, 10);
+  ASSERT_GT(checked, rebuilt);
+}
+
+TEST(System, DBStreamSnapshot) {
+  param_t cmd_params;
+  cmd_params.num_points = 5000;
+  cmd_params.dim = 2;
+  cmd_params.base = 2;
+  cmd_params.lambda = 0.001;
+  cmd_params.radius = 10;
+  cmd_params.clean_interval = 400;
+  cmd_params.min_weight = 0.5;
+  cmd_params.alpha = 0.2;
+  cmd_params.input_file = "datasets/EDS.txt";
+  cmd_params.algo = SESAME::DBStreamType;
+  cmd_params.num_clusters = 27;
+  cmd_params.time_decay = false;
+  cmd_params.snapshot_interval = 1000;
+
+  // Snapshots only read off the regions kept up online
+  cmd_params.rebuild_interval = 0;
+  ASSERT_THROW(AlgorithmFactory::create(cmd_params), std::invalid_argument);
+
+  cmd_params.rebuild_interval = 250;
+  DataSourcePtr sourcePtr = GenericFactory::New<DataSource>(cmd_params);
+  sourcePtr->load();
+  AlgorithmPtr algoPtr = AlgorithmFactory::create(cmd_params);
+  algoPtr->Init();
+  auto inputs = sourcePtr->getInputs();
+  for (int i = 0; i < 4500; i++)
+    algoPtr->RunOnline(inputs[i]);
+  auto view = algoPtr->Query();
+  ASSERT_NE(view, nullptr);
+  ASSERT_EQ(view->num_points, 4000);
+  ASSERT_FALSE(view->centers.empty());
+}
+
+TEST(System, DBStreamConcurrentQuery) {
+  param_t cmd_params;
+  cmd_params.num_points = 20000;
+  cmd_params.dim = 2;
+  cmd_params.base = 2;
+  cmd_params.lambda = 0.001;
+  cmd_params.radius = 10;
+  cmd_params.clean_interval = 400;
+  cmd_params.min_weight = 0.5;
+  cmd_params.alpha = 0.2;
+  cmd_params.input_file = "datasets/EDS.txt";
+  cmd_params.algo = SESAME::DBStreamType;
+  cmd_params.num_clusters = 27;
+  cmd_params.time_decay = false;
+  cmd_params.snapshot_interval = 100;
+  cmd_params.rebuild_interval = 250;
+
+  DataSourcePtr sourcePtr = GenericFactory::New<DataSource>(cmd_params);
+  sourcePtr->load();
+  AlgorithmPtr algoPtr = AlgorithmFactory::create(cmd_params);
+  algoPtr->Init();
+  auto inputs = sourcePtr->getInputs();
+
+  // A reader polls Query() while points are ingested. Views only move
+  // forward, and a view it holds is never modified under it
+  std::atomic<bool> done(false);
+  int views = 0;
+  bool monotone = true, intact = true;
+  std::thread reader([&] {
+    ClusterSnapshotPtr held;
+    std::vector<double> heldFeatures;
+    size_t last = 0;
+    auto features = [&](const ClusterSnapshotPtr &view) {
+      std::vector<double> values;
+      for (auto &center : view->centers)
+        for (int j = 0; j < cmd_params.dim; j++)
+          values.push_back(center->getFeatureItem(j));
+      return values;
+    };
+    while (!done.load()) {
+      auto view = algoPtr->Query();
+      if (view == nullptr)
+        continue;
+      if (view->num_points < last ||
+          view->num_points % cmd_params.snapshot_interval != 0)
+        monotone = false;
+      last = view->num_points;
+      if (held != nullptr && features(held) != heldFeatures)
+        intact = false;
+      if (view != held) {
+        held = view;
+        heldFeatures = features(view);
+        views++;
+      }
+    }
+  });
+  for (int i = 0; i < cmd_params.num_points; i++)
+    algoPtr->RunOnline(inputs[i]);
+  done.store(true);
+  reader.join();
+
+  ASSERT_TRUE(monotone);
+  ASSERT_TRUE(intact);
+  ASSERT_GT(views, 0);
+  ASSERT_EQ(algoPtr->Query()->num_points, cmd_params.num_points);
+}
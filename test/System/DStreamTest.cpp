@@ -5,8 +5,10 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <random>
 
 #include "Algorithm/AlgorithmFactory.hpp"
+#include "Algorithm/DStream.hpp"
 #include "Algorithm/DataStructure/GenericFactory.hpp"
 #include "Sinks/DataSinkFactory.hpp"
 #include "Sources/DataSourceFactory.hpp"
@@ -35,4 +37,127 @@ TEST(System, DStream) {
 
   // Run algorithm producing results.
   RunBenchmark(cmd_params);
-}
\ No newline at end of file
+}
+
+TEST(DStream, DensityAnchor) {
+  // Refreshing a grid again and again decays its density once, from the time
+  // of its last point
+  const double lambda = 0.99;
+  CharacteristicVector characteristicVec(0, -1, 1.0, -1, false, 0.5, 2.0);
+  characteristicVec.densityWithNew(10, lambda);
+  double density = std::pow(lambda, 10) + 1.0;
+  for (int now : {10, 15, 15, 40, 90})
+    characteristicVec.UpdateAllDensity(now, lambda, 0.5, 2.0);
+  ASSERT_NEAR(characteristicVec.getCurrGridDensity(120, lambda),
+              std::pow(lambda, 110) * density, 1e-12);
+  // decayed once to about 0.85, it is still between dl and dm
+  ASSERT_EQ(characteristicVec.attribute, TRANSITIONAL);
+}
+
+// Grid state as the eager D-Stream keeps it, refreshed at every gap
+struct EagerGrid {
+  double density;
+  int densityUpdateTime, updateTime, removeTime;
+  bool isSporadic = false;
+};
+
+TEST(DStream, LazyMatchesEager) {
+  // Three drifting blobs and uniform noise over a 10 x 10 grid of width 4, so
+  // grids turn dense, sparse and sporadic and some are deleted
+  param_t cmd_params;
+  cmd_params.dim = 2;
+  cmd_params.lambda = 0.998;
+  cmd_params.beta = 0.3;
+  cmd_params.cm = 3.0;
+  cmd_params.cl = 0.8;
+  cmd_params.grid_width = 4;
+  DStream dstream(cmd_params);
+  dstream.Init();
+
+  std::mt19937 generator(7);
+  std::normal_distribution<double> spread(0.0, 1.5);
+  std::uniform_real_distribution<double> uniform(0.0, 40.0);
+  std::unordered_map<DensityGrid, EagerGrid, GridKeyHash, EqualGrid> eager;
+  std::unordered_map<DensityGrid, int, GridKeyHash, EqualGrid> deleted;
+  int deletions = 0, denseGrids = 0, sparseGrids = 0, checks = 0;
+  for (int t = 0; t < 20000; t++) {
+    PointPtr point = GenericFactory::New<Point>(cmd_params.dim, t);
+    for (int j = 0; j < cmd_params.dim; j++) {
+      double center = 8.0 + 12.0 * (t % 3) + 6.0 * std::sin(t / 2000.0 + j);
+      double feature = t % 5 == 0 ? uniform(generator)
+                                  : center + spread(generator);
+      point->setFeatureItem(std::min(39.9, std::max(0.0, feature)), j);
+    }
+    dstream.RunOnline(point);
+
+    std::vector<int> coordinate(cmd_params.dim);
+    for (int j = 0; j < cmd_params.dim; j++)
+      coordinate[j] = (int)(point->getFeatureItem(j) / cmd_params.grid_width);
+    DensityGrid grid(coordinate);
+    auto iter = eager.find(grid);
+    if (iter == eager.end()) {
+      auto removed = deleted.find(grid);
+      int removeTime = removed == deleted.end() ? -1 : removed->second;
+      if (removed != deleted.end())
+        deleted.erase(removed);
+      eager.emplace(grid, EagerGrid{1.0, t, t, removeTime});
+    } else {
+      iter->second.density =
+          std::pow(cmd_params.lambda, t - iter->second.densityUpdateTime) *
+              iter->second.density +
+          1.0;
+      iter->second.densityUpdateTime = iter->second.updateTime = t;
+    }
+    if (t == 0 || t % dstream.gap != 0)
+      continue;
+
+    // Every gap the eager D-Stream deletes the sporadic grids not updated for
+    // a gap, re-checks all other grids and refreshes all densities
+    for (auto it = eager.begin(); it != eager.end();) {
+      EagerGrid &state = it->second;
+      if (state.isSporadic && t - state.updateTime >= dstream.gap) {
+        deleted[it->first] = t;
+        it = eager.erase(it);
+        deletions++;
+        continue;
+      }
+      double density =
+          std::pow(cmd_params.lambda, t - state.densityUpdateTime) *
+          state.density;
+      double decay = std::pow(cmd_params.lambda, t - state.updateTime + 1);
+      double pi = cmd_params.cl * (1.0 - decay) /
+                  (dstream.NGrids * (1.0 - cmd_params.lambda));
+      state.isSporadic =
+          density < pi && (state.removeTime == 0 ||
+                           t - (1 + cmd_params.beta) * state.removeTime >= 0);
+      state.density = density;
+      state.densityUpdateTime = t;
+      ++it;
+    }
+
+    ASSERT_EQ(dstream.gridList.size(), eager.size()) << "at " << t;
+    for (auto &[eagerGrid, state] : eager) {
+      auto lazy = dstream.gridList.find(eagerGrid);
+      ASSERT_NE(lazy, dstream.gridList.end()) << "at " << t;
+      ASSERT_EQ(lazy->second.isSporadic, state.isSporadic) << "at " << t;
+      double density = lazy->second.getCurrGridDensity(t, cmd_params.lambda);
+      double tolerance = 1e-9 * std::max(1.0, state.density);
+      ASSERT_NEAR(density, state.density, tolerance) << "at " << t;
+      // Attributes of grids on a threshold depend on rounding
+      if (std::fabs(state.density - dstream.dl) < tolerance ||
+          std::fabs(state.density - dstream.dm) < tolerance)
+        continue;
+      int attribute = state.density <= dstream.dl   ? SPARSE
+                      : state.density >= dstream.dm ? DENSE
+                                                    : TRANSITIONAL;
+      ASSERT_EQ(lazy->second.attribute, attribute) << "at " << t;
+      denseGrids += attribute == DENSE;
+      sparseGrids += attribute == SPARSE;
+    }
+    checks++;
+  }
+  ASSERT_GT(checks, 100);
+  ASSERT_GT(deletions, 0);
+  ASSERT_GT(denseGrids, 0);
+  ASSERT_GT(sparseGrids, 0);
+}
@@ -6,6 +6,9 @@
 //
 
 #include <filesystem>
+#include <map>
+#include <omp.h>
+#include <random>
 
 #include "Algorithm/AlgorithmFactory.hpp"
 #include "Algorithm/DataStructure/CFTree.hpp"
@@ -17,6 +20,7 @@
 #include "Algorithm/OfflineRefinement/OfflineRefinement.hpp"
 #include "Algorithm/OutlierDetection/OutlierDetection.hpp"
 #include "Algorithm/WindowModel/WindowModel.hpp"
+#include "Evaluation/CMM.hpp"
 #include "Sinks/DataSinkFactory.hpp"
 #include "Sources/DataSourceFactory.hpp"
 #include "Utils/BenchmarkUtils.hpp"
@@ -376,3 +380,221 @@ TEST(System, V16) {
   // Run algorithm producing results.
   auto res = SESAME::RunBenchmark(cmd_params);
 }
+
+TEST(System, V17) {
+  param_t param;
+  param.num_points = 3000;
+  param.distance_threshold = 100;
+  param.max_in_nodes = 10;
+  param.max_leaf_nodes = 20;
+  param.dim = 54;
+  param.seed = 10;
+  param.num_clusters = 7;
+  param.time_decay = false;
+  param.landmark = 1000;
+  param.outlier_distance_threshold = 5000;
+  param.outlier_cap = 10;
+  param.k = 7;
+
+  param.input_file = "datasets/CoverType.txt";
+  param.algo = G17Stream;
+  param.run_offline = true;
+
+  // Run algorithm producing results.
+  auto res = SESAME::RunBenchmark(param);
+
+  ASSERT_NEAR(res.first.purity, 0.802, 0.02);
+}
+
+// Eight blobs of 5000 points in 5 dims, enough for several sum blocks of the
+// Lloyd iterations
+class KMeansTest : public ::testing::Test {
+protected:
+  const int numberOfInput = 5000, dim = 5;
+  std::vector<PointPtr> input;
+
+  void SetUp() override {
+    std::mt19937 generator(7);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    for (int i = 0; i < numberOfInput; i++) {
+      PointPtr point = GenericFactory::New<Point>(dim, i);
+      for (int j = 0; j < dim; j++)
+        point->setFeatureItem(10.0 * ((i % 8) >> (j % 3) & 1) +
+                                  noise(generator),
+                              j);
+      input.push_back(point);
+    }
+  }
+
+  void run(int numberOfCenters, bool pruning, int threads,
+           std::vector<PointPtr> &centers,
+           std::vector<std::vector<PointPtr>> &groups) {
+    param_t param;
+    param.kmeans_pruning = pruning;
+    int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(threads);
+    KMeans kmeans(param);
+    std::vector<std::vector<PointPtr>> newGroups;
+    kmeans.runKMeans(numberOfCenters, numberOfInput, centers, input, groups,
+                     newGroups, 10, false);
+    omp_set_num_threads(maxThreads);
+  }
+
+  static void expectSameClustering(
+      const std::vector<PointPtr> &centers,
+      const std::vector<std::vector<PointPtr>> &groups,
+      const std::vector<PointPtr> &otherCenters,
+      const std::vector<std::vector<PointPtr>> &otherGroups) {
+    ASSERT_EQ(centers.size(), otherCenters.size());
+    for (size_t c = 0; c < centers.size(); c++) {
+      ASSERT_EQ(groups[c].size(), otherGroups[c].size());
+      for (size_t i = 0; i < groups[c].size(); i++)
+        ASSERT_EQ(groups[c][i]->getIndex(), otherGroups[c][i]->getIndex());
+      for (int j = 0; j < centers[c]->getDimension(); j++)
+        ASSERT_EQ(centers[c]->getFeatureItem(j),
+                  otherCenters[c]->getFeatureItem(j));
+    }
+  }
+};
+
+TEST_F(KMeansTest, BlockSums) {
+  std::vector<PointPtr> centers, threadedCenters;
+  std::vector<std::vector<PointPtr>> groups, threadedGroups;
+  run(8, false, 1, centers, groups);
+  run(8, false, 4, threadedCenters, threadedGroups);
+
+  // The means do not depend on the number of threads
+  expectSameClustering(centers, groups, threadedCenters, threadedGroups);
+  // and match the means summed in input order, as before the block sums
+  for (size_t c = 0; c < centers.size(); c++) {
+    if (groups[c].empty())
+      continue;
+    for (int j = 0; j < dim; j++) {
+      double sum = 0;
+      for (auto &point : groups[c])
+        sum += point->getFeatureItem(j);
+      double mean = sum / double(groups[c].size());
+      ASSERT_NEAR(centers[c]->getFeatureItem(j), mean,
+                  1e-12 * (1 + std::fabs(mean)));
+    }
+  }
+}
+
+TEST_F(KMeansTest, HamerlyMatchesLloyd) {
+  // More centers than blobs, so the bounds skip some points and rescan others
+  for (int numberOfCenters : {8, 20}) {
+    std::vector<PointPtr> centers, prunedCenters;
+    std::vector<std::vector<PointPtr>> groups, prunedGroups;
+    run(numberOfCenters, false, 1, centers, groups);
+    run(numberOfCenters, true, 1, prunedCenters, prunedGroups);
+    expectSameClustering(centers, groups, prunedCenters, prunedGroups);
+  }
+}
+
+TEST(CMM, SampledKnnMeanBound) {
+  // One ground truth cluster of 3000 points
+  std::mt19937 generator(7);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::vector<PointPtr> inputs;
+  for (int i = 0; i < 3000; i++) {
+    PointPtr point = GenericFactory::New<Point>(3, i);
+    for (int j = 0; j < 3; j++)
+      point->setFeatureItem(noise(generator), j);
+    point->setClusteringCenter(1);
+    inputs.push_back(point);
+  }
+  auto knn = [&](size_t sampleSize, unsigned seed) {
+    CMM::Cluster cluster;
+    for (int i = 0; i < (int)inputs.size(); i++)
+      cluster.Insert(i);
+    std::mt19937 rng(seed);
+    std::vector<char> knnKnown(inputs.size(), 0);
+    cluster.CalcKnn(2, inputs, sampleSize, rng, knnKnown);
+    return std::make_pair(cluster.knnMeanAvg, cluster.knnMeanBound);
+  };
+  auto [exact, exactBound] = knn(0, 0);
+  ASSERT_EQ(exactBound, 0);
+
+  // The exact mean lies within the reported 95% bound of most samples
+  int covered = 0;
+  for (unsigned seed = 0; seed < 40; seed++) {
+    auto [sampled, bound] = knn(200, seed);
+    ASSERT_GT(bound, 0);
+    if (std::fabs(sampled - exact) <= bound)
+      covered++;
+  }
+  ASSERT_GE(covered, 34);
+}
+
+TEST(DBSCAN, RegionQueries) {
+  // The grid answers the region queries in 2 dims and the kd-tree in 6, both
+  // must find the clusters of a brute-force region query
+  for (int dim : {2, 6}) {
+    std::mt19937 generator(7);
+    std::normal_distribution<double> noise(0.0, 0.5);
+    std::uniform_real_distribution<double> uniform(-5.0, 25.0);
+    std::vector<PointPtr> input;
+    for (int i = 0; i < 800; i++) {
+      PointPtr point = GenericFactory::New<Point>(dim, i);
+      for (int j = 0; j < dim; j++)
+        point->setFeatureItem(i < 700 ? 10.0 * ((i % 6) >> (j % 3) & 1) +
+                                            noise(generator)
+                                      : uniform(generator),
+                              j);
+      input.push_back(point);
+    }
+    const double epsilon = 1.0;
+    const unsigned minPoints = 5;
+    DBSCAN dbscan(minPoints, epsilon);
+    dbscan.run(input);
+
+    int size = (int)input.size();
+    std::vector<std::vector<int>> regions(size);
+    for (int i = 0; i < size; i++)
+      for (int other = 0; other < size; other++)
+        if (input[i]->L2Dist(input[other]) <= epsilon)
+          regions[i].push_back(other);
+    // Clusters are the connected components of the core points
+    std::vector<int> component(size, -1);
+    for (int i = 0; i < size; i++) {
+      if (regions[i].size() < minPoints || component[i] >= 0)
+        continue;
+      std::vector<int> stack{i};
+      component[i] = i;
+      while (!stack.empty()) {
+        int point = stack.back();
+        stack.pop_back();
+        for (int other : regions[point])
+          if (regions[other].size() >= minPoints && component[other] < 0) {
+            component[other] = i;
+            stack.push_back(other);
+          }
+      }
+    }
+    std::map<int, int> labelOfComponent, componentOfLabel;
+    for (int i = 0; i < size; i++) {
+      int label = input[i]->getClusteringCenter();
+      if (component[i] >= 0) {
+        ASSERT_GE(label, 0);
+        auto known = labelOfComponent.emplace(component[i], label);
+        ASSERT_EQ(known.first->second, label);
+        auto knownLabel = componentOfLabel.emplace(label, component[i]);
+        ASSERT_EQ(knownLabel.first->second, component[i]);
+        continue;
+      }
+      // A border point joins the cluster of one of its core neighbours, the
+      // others are noise
+      bool joined = false, border = false;
+      for (int other : regions[i])
+        if (component[other] >= 0) {
+          border = true;
+          joined = joined || input[other]->getClusteringCenter() == label;
+        }
+      if (border)
+        ASSERT_TRUE(joined);
+      else
+        ASSERT_EQ(label, NOISE);
+    }
+    ASSERT_GT(labelOfComponent.size(), 1);
+  }
+}
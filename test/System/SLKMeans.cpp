@@ -6,6 +6,7 @@
 //
 
 #include <filesystem>
+#include <random>
 
 #include "Algorithm/AlgorithmFactory.hpp"
 #include "Algorithm/DataStructure/GenericFactory.hpp"
@@ -41,6 +42,57 @@ TEST(System, SLKMeans) {
   // Run algorithm producing results.
   auto res = SESAME::RunBenchmark(cmd_params);
 
-  ASSERT_NEAR(res.first.purity, 0.47, 0.03);
-  ASSERT_NEAR(res.first.cmm, 0.80, 0.03);
+  ASSERT_EQ(res.first.num_res, 3);
+  ASSERT_NEAR(res.first.purity, 0.4263, 0.03);
+  ASSERT_NEAR(res.first.cmm, 0.4655, 0.03);
+}
+
+TEST(SLKMeans, CostSamplesWorkers) {
+  // Four instances of 100 points each
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> coordinate(0.0, 100.0);
+  std::vector<PointPtr> samples;
+  for (int i = 0; i < 400; i++) {
+    auto point = GenericFactory::New<Point>(3, i);
+    for (int j = 0; j < 3; j++)
+      point->setFeatureItem(coordinate(generator), j);
+    samples.push_back(point);
+  }
+  std::vector<int> seeds = {11, 12, 13, 14};
+
+  // Every instance draws from its own seed, so the number of workers solving
+  // them does not change the costs
+  auto single = cost_samples(seeds, samples, 100, 4, 7, 1);
+  auto pooled = cost_samples(seeds, samples, 100, 4, 7, 3);
+  ASSERT_EQ(single.size(), 4);
+  ASSERT_EQ(single, pooled);
+}
+
+TEST(SLKMeans, KMeansPlusPlusDuplicates) {
+  Random r(10);
+  std::vector<std::pair<PointPtr, double>> instance;
+  for (int i = 0; i < 10; i++) {
+    auto point = GenericFactory::New<Point>(2, i);
+    point->setFeatureItem(i % 2, 0);
+    point->setFeatureItem(1.0, 1);
+    instance.push_back(std::make_pair(point, 1.0));
+  }
+
+  // Only two distinct points: seeding stops once every point lies on a
+  // center instead of drawing from an empty distribution
+  std::vector<int32_t> centers;
+  double cost = -1;
+  k_means_plus_plus(&r, instance, 3, &centers, &cost);
+  ASSERT_EQ(centers.size(), 2);
+  ASSERT_NE(instance[centers[0]].first->getFeatureItem(0),
+            instance[centers[1]].first->getFeatureItem(0));
+  ASSERT_EQ(cost, 0);
+
+  // Points without weight carry no mass either
+  for (auto &[point, weight] : instance)
+    weight = point->getFeatureItem(0) == 0 ? 1.0 : 0.0;
+  k_means_plus_plus(&r, instance, 3, &centers, &cost);
+  ASSERT_GE(centers.size(), 1);
+  ASSERT_LE(centers.size(), 2);
+  ASSERT_EQ(cost, 0);
 }
@@ -11,10 +11,13 @@
 
 #include "Algorithm/AlgorithmFactory.hpp"
 #include "Algorithm/DataStructure/GenericFactory.hpp"
+#include "Algorithm/WindowModel/WindowFactory.hpp"
 #include "Sinks/DataSinkFactory.hpp"
+#include "Sources/DataSource.hpp"
 #include "Sources/DataSourceFactory.hpp"
 #include "Utils/BenchmarkUtils.hpp"
 #include "Utils/Logger.hpp"
+#include "Utils/UtilityFunctions.hpp"
 
 using namespace SESAME;
 
@@ -38,4 +41,56 @@ TEST(System, StreamKM) {
 
   // Run algorithm producing results.
   RunBenchmark(cmd_params);
-}
\ No newline at end of file
+}
+
+// Builds StreamKM++'s coreset of the first EDS points directly on a landmark
+// window, set up as StreamKM::Init does
+class StreamKMTest : public ::testing::Test {
+protected:
+  param_t params;
+  std::vector<PointPtr> inputs;
+
+  void SetUp() override {
+    params.num_points = 46000;
+    params.seed = 10;
+    params.dim = 2;
+    params.coreset_size = 100;
+    params.k = 27;
+    params.time_decay = false;
+    params.input_file = "datasets/EDS.txt";
+    DataSourcePtr sourcePtr = GenericFactory::New<DataSource>(params);
+    sourcePtr->load();
+    inputs = sourcePtr->getInputs();
+  }
+
+  std::vector<PointPtr> coreset(int mergeWorkers) {
+    UtilityFunctions::init_genrand(params.seed);
+    LandmarkWindowPtr window = WindowFactory::createLandmarkWindow();
+    window->windowManager.numberOfWindow =
+        ceil(log((double)params.num_points / params.coreset_size) / log(2)) +
+        2;
+    window->windowManager.maxWindowSize = (int)params.coreset_size;
+    window->initWindow((int)params.coreset_size);
+    window->tree = GenericFactory::New<LandmarkWindow::CoresetTree>(params);
+    if (mergeWorkers > 0)
+      window->initAsyncMerge(mergeWorkers, params.seed);
+    for (auto &input : inputs)
+      window->insertPoint(input->copy());
+    std::vector<PointPtr> coreset;
+    window->getCoresetFromManager(coreset);
+    return coreset;
+  }
+};
+
+TEST_F(StreamKMTest, MergeWorkers) {
+  // The coresets depend on the seed but not on the size of the merge pool
+  auto single = coreset(1);
+  auto pooled = coreset(4);
+  ASSERT_EQ(single.size(), params.coreset_size);
+  ASSERT_EQ(pooled.size(), single.size());
+  for (size_t i = 0; i < single.size(); i++) {
+    ASSERT_EQ(pooled[i]->getWeight(), single[i]->getWeight());
+    for (int j = 0; j < params.dim; j++)
+      ASSERT_EQ(pooled[i]->getFeatureItem(j), single[i]->getFeatureItem(j));
+  }
+}